@@ -0,0 +1,23 @@
+#ifndef __ALLOCATIONCOUNTER_HPP__
+#define __ALLOCATIONCOUNTER_HPP__
+
+#include <cstdint>
+
+// Counts calls to the global operator new in the COUNT_ALLOCATIONS build
+// (`make counted`, output/main-counted); otherwise nothing is replaced and
+// the count stays 0. Used to check that the play loop does not allocate once started.
+class AllocationCounter {
+    private:
+        AllocationCounter() = delete;
+        ~AllocationCounter() = delete;
+    public:
+        static constexpr bool enabled() {
+            #ifdef COUNT_ALLOCATIONS
+                return true;
+            #else
+                return false;
+            #endif
+        }
+        static uint64_t count();
+};
+#endif // __ALLOCATIONCOUNTER_HPP__
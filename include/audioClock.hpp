@@ -0,0 +1,48 @@
+#ifndef __AUDIOCLOCK_HPP__
+#define __AUDIOCLOCK_HPP__
+
+#include <chrono>
+#include <cstdint>
+#include "miniaudio.h"
+
+// How far the wall clock has moved away from the audio clock:
+// positive when the audio is behind
+struct ClockDriftStats {
+    int64_t lastUs = 0;
+    int64_t maxAbsUs = 0;
+    int64_t sumAbsUs = 0;
+    size_t samples = 0;
+
+    int64_t meanAbsUs() const { return samples > 0 ? sumAbsUs / static_cast<int64_t>(samples) : 0; }
+};
+
+// Song position taken from the sound's PCM cursor, the master clock for
+// lyric scheduling. The cursor only moves once per audio period, so between
+// updates steady_clock interpolates, for at most MAX_INTERPOLATION_US so a
+// stalled device holds the lyrics back instead of running ahead. Once the
+// sound has ended the wall clock carries on alone. Not thread-safe.
+class AudioClock {
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        ma_sound* sound = nullptr;
+        ma_uint32 sampleRate = 0;
+        ma_uint64 lastFrames = 0;
+        int64_t anchorUs = 0;
+        int64_t lastUs = 0;
+        Clock::time_point anchorTime;
+        Clock::time_point startTime;
+        ClockDriftStats drift;
+    public:
+        static constexpr int64_t MAX_INTERPOLATION_US = 100000;
+
+        bool attach(ma_sound*);
+        void start();
+        int64_t nowUs();
+
+        int64_t framesToUs(ma_uint64) const;
+        ma_uint64 usToFrames(int64_t) const;
+        ma_uint32 rate() const { return sampleRate; }
+        const ClockDriftStats& driftStats() const { return drift; }
+};
+#endif // __AUDIOCLOCK_HPP__
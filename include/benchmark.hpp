@@ -0,0 +1,18 @@
+#ifndef __BENCHMARK_HPP__
+#define __BENCHMARK_HPP__
+
+#include <string>
+#include <vector>
+
+// Command line benchmarks: output/main --bench-<name> [files...]
+class Benchmark {
+    private:
+        Benchmark() = delete;
+        ~Benchmark() = delete;
+    public:
+        static int parser(const std::vector<std::string>&);
+        static int cache(const std::vector<std::string>&);
+        static int memory(const std::vector<std::string>&);
+        static int terminal(const std::vector<std::string>&);
+};
+#endif // __BENCHMARK_HPP__
@@ -0,0 +1,29 @@
+#ifndef __CASTWRITER_HPP__
+#define __CASTWRITER_HPP__
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include "renderer.hpp"
+
+// Records rendered frames as an asciinema v2 .cast file: a JSON header with
+// the screen size, then one [seconds, "o", bytes] event per frame, timed by
+// the song clock rather than the wall clock.
+class CastWriter : public FrameSink {
+    private:
+        std::ofstream file;
+        uint64_t events = 0;
+
+        void writeTime(int64_t);
+        void writeString(std::string_view);
+    public:
+        bool open(const std::string&, int, int, std::string_view);
+        // ends the recording at timeUs, so the last frame stays up until then
+        void close(int64_t);
+
+        void frame(int64_t, std::string_view) override;
+
+        uint64_t eventCount() const { return events; }
+};
+#endif // __CASTWRITER_HPP__
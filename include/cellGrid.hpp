@@ -0,0 +1,65 @@
+#ifndef __CELLGRID_HPP__
+#define __CELLGRID_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "frameBuffer.hpp"
+
+// Off-screen copy of the terminal, one cell per column: what the play loop
+// draws goes to the back grid, and render() sends only the cells that differ
+// from the front grid (what the terminal already shows), with as few cursor
+// moves and colour changes as it can. Unchanged rows are skipped with one
+// memcmp each, so a redraw that changes nothing costs no output at all.
+class CellGrid {
+    public:
+        // UTF-8 bytes of one code point plus any zero-width ones after it.
+        // The second column of a wide character holds an empty cell.
+        struct Cell {
+            uint8_t length;
+            char bytes[11];
+            int32_t color;
+        };
+    private:
+        int width = 0;
+        int height = 0;
+        std::vector<Cell> back;
+        std::vector<Cell> front;
+
+        int cursorX = 0;
+        int cursorY = 0;
+        int color = 0;
+        // what the terminal is set to, -1 when unknown
+        int terminalColor = -1;
+        int terminalX = -1;
+        int terminalY = -1;
+
+        uint64_t cellsSent = 0;
+        bool drawn = false;
+
+        void put(std::string_view, int);
+        void sendRow(int, FrameBuffer&);
+    public:
+        void resize(int, int);
+
+        void moveCursor(int, int);
+        void setTextColor(int);
+        void spaces(size_t);
+        void repeat(std::string_view, size_t);
+        void number(int64_t, int width = 0);
+        void drawBox(int, int, int, int, int);
+
+        CellGrid& operator<<(std::string_view);
+
+        void render(FrameBuffer&);
+
+        // the back grid, to hand to another thread; setCells takes one of the same size
+        const std::vector<Cell>& cells() const { return back; }
+        void setCells(const std::vector<Cell>&);
+        // whether anything was drawn since the last call
+        bool takeChanges();
+
+        uint64_t cellsRendered() const { return cellsSent; }
+};
+#endif // __CELLGRID_HPP__
@@ -54,6 +54,15 @@ struct Rect {
     int height;
 };
 
+// What the terminal understands, worked out once from $TERM (or the console
+// mode on Windows) so nothing has to spawn clear, resize or tput later
+struct TerminalCapabilities {
+    bool isTerminal = false;    // stdout is a terminal, not a file or pipe
+    bool ansi = false;          // cursor movement, erasing and colours
+    bool windowTitle = false;   // OSC 0 title changes
+    bool windowResize = false;  // xterm window size requests
+};
+
 
 class ConsoleUtils {
     private:
@@ -62,9 +71,11 @@ class ConsoleUtils {
         #ifdef _WIN32
             static HANDLE hConsole;
         #endif
+        static TerminalCapabilities detectTerminal();
     public:
         static int consoleWidth;
         static int consoleHeight;
+        static const TerminalCapabilities capabilities;
 
         static void clearConsole();
         static void setTextColor(int);
@@ -0,0 +1,54 @@
+#ifndef __CUESOURCE_HPP__
+#define __CUESOURCE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "miniaudio.h"
+#include "spscQueue.hpp"
+
+// miniaudio data source wrapping the song's decoder. The UI thread arms the
+// frame of the next lyric cue; when a read in the audio callback reaches it
+// the cue is posted through a lock-free queue and an eventfd wakes the UI
+// thread, so line changes land within one audio period. The eventfd is
+// waited on by the DeadlineScheduler; without eventfd it is -1 and the
+// scheduler checks back on its own.
+class CueSource {
+    private:
+        // must stay first: miniaudio passes a pointer to it back to the callbacks
+        ma_data_source_base base;
+        ma_decoder decoder;
+        bool initialized = false;
+
+        std::atomic<uint64_t> armedFrame{NO_CUE};
+        SpscQueue<uint64_t, 64> cues;
+        std::atomic<uint64_t> postedCues{0};
+        std::atomic<uint64_t> droppedCues{0};
+        int wakeFd = -1;
+
+        static ma_result onRead(ma_data_source*, void*, ma_uint64, ma_uint64*);
+        static ma_result onSeek(ma_data_source*, ma_uint64);
+        static ma_result onGetDataFormat(ma_data_source*, ma_format*, ma_uint32*, ma_uint32*, ma_channel*, size_t);
+        static ma_result onGetCursor(ma_data_source*, ma_uint64*);
+        static ma_result onGetLength(ma_data_source*, ma_uint64*);
+        static const ma_data_source_vtable vtable;
+    public:
+        static constexpr uint64_t NO_CUE = UINT64_MAX;
+
+        CueSource() = default;
+        ~CueSource();
+        CueSource(const CueSource&) = delete;
+        CueSource& operator=(const CueSource&) = delete;
+
+        bool open(const std::string&);
+        void close();
+        ma_data_source* dataSource() { return &base; }
+
+        void arm(uint64_t);
+        int wakeHandle() const { return wakeFd; }
+        size_t acknowledge();
+
+        uint64_t posted() const { return postedCues.load(); }
+        uint64_t dropped() const { return droppedCues.load(); }
+};
+#endif // __CUESOURCE_HPP__
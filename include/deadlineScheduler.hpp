@@ -0,0 +1,42 @@
+#ifndef __DEADLINESCHEDULER_HPP__
+#define __DEADLINESCHEDULER_HPP__
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Sleeps the play loop until its next deadline or until a watched file
+// descriptor (the audio cue eventfd) becomes readable. On Linux this is one
+// epoll_wait over an absolute timerfd and the watched descriptors; elsewhere
+// it falls back to sleep_until. Counts wakeups so idle cost can be compared.
+class DeadlineScheduler {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        enum class Wake {
+            Deadline,
+            Event
+        };
+    private:
+        int epollFd = -1;
+        int timerFd = -1;
+        std::vector<int> watched;
+
+        Clock::time_point started;
+        uint64_t deadlineWakeups = 0;
+        uint64_t eventWakeups = 0;
+    public:
+        DeadlineScheduler();
+        ~DeadlineScheduler();
+        DeadlineScheduler(const DeadlineScheduler&) = delete;
+        DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+        void watch(int);
+        Wake waitUntil(Clock::time_point);
+
+        void resetStats();
+        uint64_t wakeups() const { return deadlineWakeups + eventWakeups; }
+        uint64_t eventWakeupCount() const { return eventWakeups; }
+        double wakeupsPerSecond() const;
+};
+#endif // __DEADLINESCHEDULER_HPP__
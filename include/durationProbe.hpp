@@ -0,0 +1,35 @@
+#ifndef __DURATIONPROBE_HPP__
+#define __DURATIONPROBE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Measures the length of an audio file on a background thread with its own
+// decoder, for formats whose length is only known after reading every frame
+// (MP3 without a usable header). Playback never waits for it.
+class DurationProbe {
+    private:
+        struct State {
+            std::atomic<int64_t> lengthUs{-1};
+        };
+
+        std::shared_ptr<State> state;
+        std::thread scanner;
+
+        static void scan(std::shared_ptr<State>, std::string);
+    public:
+        DurationProbe() = default;
+        ~DurationProbe();
+        DurationProbe(const DurationProbe&) = delete;
+        DurationProbe& operator=(const DurationProbe&) = delete;
+
+        void start(const std::string&);
+        void stop();
+
+        // -1 until the scan has finished, 0 if it failed
+        int64_t lengthUs() const { return state ? state->lengthUs.load() : -1; }
+};
+#endif // __DURATIONPROBE_HPP__
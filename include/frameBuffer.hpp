@@ -0,0 +1,49 @@
+#ifndef __FRAMEBUFFER_HPP__
+#define __FRAMEBUFFER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Collects everything drawn during one pass of the play loop (cursor moves,
+// colours and text) in a preallocated buffer and hands it to the terminal
+// with a single write(2) in present(). Counts write calls and bytes so the
+// output cost per frame can be compared.
+class FrameBuffer {
+    private:
+        std::vector<char> buffer;
+        size_t used = 0;
+        // -1 keeps frames off the terminal; they are still counted
+        int outputFd = 1;
+
+        uint64_t frames = 0;
+        uint64_t writeCalls = 0;
+        uint64_t bytesWritten = 0;
+
+        void grow(size_t);
+    public:
+        static constexpr size_t INITIAL_CAPACITY = 16384;
+
+        FrameBuffer();
+
+        void setOutput(int fd) { outputFd = fd; }
+
+        void moveCursor(int, int);
+        void setTextColor(int);
+        void spaces(size_t);
+        void repeat(std::string_view, size_t);
+        void number(int64_t, int width = 0);
+
+        FrameBuffer& operator<<(std::string_view);
+        FrameBuffer& operator<<(char);
+
+        void present();
+
+        bool empty() const { return used == 0; }
+        std::string_view contents() const { return std::string_view(buffer.data(), used); }
+        uint64_t frameCount() const { return frames; }
+        uint64_t writeCount() const { return writeCalls; }
+        uint64_t byteCount() const { return bytesWritten; }
+};
+#endif // __FRAMEBUFFER_HPP__
@@ -0,0 +1,43 @@
+#ifndef __LIBRARYINDEXER_HPP__
+#define __LIBRARYINDEXER_HPP__
+
+#include <string>
+#include <vector>
+
+struct LibraryTrack {
+    std::string audioPath;
+    std::string lyricsPath;
+    std::string title;
+    std::string artist;
+    size_t lyricLines = 0;
+    bool lyricsLoaded = false;
+    std::string error;
+};
+
+struct LibraryIndexStats {
+    size_t audioFiles = 0;
+    size_t lyricsFiles = 0;
+    size_t parsedLyrics = 0;
+    size_t pairedTracks = 0;
+    size_t failedLyrics = 0;
+    size_t lyricLines = 0;
+    size_t threads = 0;
+    size_t stolenTasks = 0;
+    double walkSeconds = 0.0;
+    double parseSeconds = 0.0;
+};
+
+// Walks a directory tree, pairs audio files with .lrc/.txt lyrics that share
+// their basename and parses every lyrics file on a thread pool.
+class LibraryIndexer {
+    private:
+        size_t threadCount;
+        bool useCache;
+    public:
+        LibraryIndexer(size_t threads, bool cache);
+
+        bool index(const std::string&, std::vector<LibraryTrack>&, LibraryIndexStats&) const;
+
+        static int run(const std::vector<std::string>&);
+};
+#endif // __LIBRARYINDEXER_HPP__
@@ -0,0 +1,30 @@
+#ifndef __LRCSCANNER_HPP__
+#define __LRCSCANNER_HPP__
+
+#include <string_view>
+
+enum class LrcLineKind {
+    Noise,
+    Tag,
+    Timestamp
+};
+
+struct LrcScanResult {
+    LrcLineKind kind = LrcLineKind::Noise;
+    std::string_view name;   // tag name, or every leading [time] tag of the line
+    std::string_view value;  // tag value, or the lyric text after the tags
+};
+
+// Hand-written, single forward pass classifier for LRC lines.
+// The views returned point into the line passed to scanLine.
+class LrcScanner {
+    private:
+        LrcScanner() = delete;
+        ~LrcScanner() = delete;
+    public:
+        static LrcScanResult scanLine(std::string_view);
+        static bool scanTime(std::string_view, size_t&);
+        static std::string_view nextTime(std::string_view&);
+        static bool scanWordTag(std::string_view, size_t, std::string_view&, size_t&);
+};
+#endif // __LRCSCANNER_HPP__
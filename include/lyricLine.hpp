@@ -1,18 +1,20 @@
 #ifndef __LYRICLINE_HPP__
 #define __LYRICLINE_HPP__
 
+#include <cstdint>
 #include <iostream>
 #include <string>
-#include <regex>
+#include <string_view>
 
 class LyricLine {
 public:
-    double timeInSeconds;
-    std::string text;
+    int64_t timeInMicros;
+    std::string_view text;   // points into the storage owned by the Song
     bool isEmpty;
     
-    LyricLine(double, const std::string&);
+    LyricLine(int64_t, std::string_view);
     
-    static double parseTime(const std::string&);
+    static bool parseTime(std::string_view, int64_t&);
+    static bool parseOffset(std::string_view, int64_t&);
 };
-#endif // __LYRICLINE_HPP__
\ No newline at end of file
+#endif // __LYRICLINE_HPP__
@@ -0,0 +1,77 @@
+#ifndef __LYRICTIMELINE_HPP__
+#define __LYRICTIMELINE_HPP__
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+// Structure-of-arrays lyric store: timestamps in integer microseconds, the
+// text views and an empty-line bitmap live in separate contiguous arrays so
+// time lookups only touch the timestamps. Lines are kept in time order.
+// Each line also carries its width in terminal columns, measured once.
+//
+// Enhanced LRC word timings are stored once per unique line: each line
+// refers to a range of the word arrays, which hold the word start as an
+// offset from the line's timestamp and its byte position in the text.
+class LyricTimeline {
+    private:
+        std::vector<int64_t> timesUs;
+        std::vector<std::string_view> texts;
+        std::vector<uint32_t> columns;
+        std::vector<uint64_t> emptyBits;
+        std::vector<uint32_t> firstWord;
+        std::vector<uint32_t> wordCounts;
+
+        std::vector<int32_t> wordOffsetsUs;
+        std::vector<uint32_t> wordPositions;
+    public:
+        static const size_t npos = std::numeric_limits<size_t>::max();
+        static const int64_t never = std::numeric_limits<int64_t>::max();
+
+        // Playback position that only moves forward in the common case
+        class Cursor {
+            private:
+                const LyricTimeline* timeline;
+                size_t nextLine = 0;
+            public:
+                explicit Cursor(const LyricTimeline& t) : timeline(&t) {}
+
+                bool advance(int64_t);
+                size_t seek(int64_t);
+
+                size_t current() const { return nextLine == 0 ? npos : nextLine - 1; }
+                int64_t nextTime() const;
+        };
+
+        void reserve(size_t);
+        void clear();
+        void append(int64_t, std::string_view, uint32_t, uint32_t firstWordIndex = 0, uint32_t wordCount = 0);
+        uint32_t addWord(int32_t, uint32_t);
+        void assign(const int64_t*, std::vector<std::string_view>&&, const uint32_t*, const uint32_t*, const uint32_t*);
+        void assignWords(const int32_t*, const uint32_t*, size_t);
+        void sortByTime(size_t first = 0);
+        void mergeFrom(const LyricTimeline&, size_t);
+        void shift(int64_t);
+
+        size_t lineAt(int64_t) const;
+        size_t highlightedBytes(size_t, int64_t) const;
+        int64_t nextWordTime(size_t, int64_t) const;
+
+        size_t size() const { return timesUs.size(); }
+        bool empty() const { return timesUs.empty(); }
+        int64_t timeAt(size_t i) const { return timesUs[i]; }
+        std::string_view textAt(size_t i) const { return texts[i]; }
+        size_t columnsAt(size_t i) const { return columns[i]; }
+        bool isEmptyLine(size_t i) const { return (emptyBits[i / 64] >> (i % 64)) & 1; }
+        const int64_t* times() const { return timesUs.data(); }
+        const uint32_t* textColumns() const { return columns.data(); }
+
+        bool hasWords(size_t i) const { return wordCounts[i] != 0; }
+        size_t totalWords() const { return wordOffsetsUs.size(); }
+        const uint32_t* firstWords() const { return firstWord.data(); }
+        const uint32_t* lineWordCounts() const { return wordCounts.data(); }
+        const int32_t* wordOffsets() const { return wordOffsetsUs.data(); }
+        const uint32_t* wordBytePositions() const { return wordPositions.data(); }
+};
+#endif // __LYRICTIMELINE_HPP__
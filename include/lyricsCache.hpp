@@ -0,0 +1,53 @@
+#ifndef __LYRICSCACHE_HPP__
+#define __LYRICSCACHE_HPP__
+
+#include <cstdint>
+#include <string>
+#include "lyricsData.hpp"
+
+// Layout of a .lrcb sidecar, written next to the lyrics file after the
+// first parse and mapped directly on later loads:
+//
+//   LyricsCacheHeader
+//   int64_t  times[lineCount]          microseconds, in timeline order
+//   uint32_t textOffsets[lineCount]    line i is text[offsets[i], offsets[i] + lengths[i])
+//   uint32_t textLengths[lineCount]
+//   uint32_t firstWords[lineCount]     enhanced LRC word range of each line
+//   uint32_t wordCounts[lineCount]
+//   uint32_t textColumns[lineCount]    terminal width of each line
+//   int32_t  wordOffsets[wordCount]    microseconds after the line's timestamp
+//   uint32_t wordPositions[wordCount]  byte position in the line's text
+//   char     text[textSize]            unique lyric text followed by title, artist, length
+//
+// Lines that share a text slice (repeated choruses) share it in the blob too.
+struct LyricsCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint32_t lineCount;
+    uint32_t maxLyricLength;           // columns
+    uint32_t titleOffset;
+    uint32_t titleLength;
+    uint32_t artistOffset;
+    uint32_t artistLength;
+    uint32_t lengthOffset;
+    uint32_t lengthLength;
+    uint64_t textSize;
+    uint32_t wordCount;
+    uint32_t flags;
+};
+
+class LyricsCache {
+    private:
+        LyricsCache() = delete;
+        ~LyricsCache() = delete;
+    public:
+        static const uint32_t VERSION = 7;
+        static const uint32_t INVALID_UTF8 = 1;
+
+        static std::string sidecarPath(const std::string&);
+        static bool load(const std::string&, LyricsData&);
+        static bool write(const std::string&, const LyricsData&);
+};
+#endif // __LYRICSCACHE_HPP__
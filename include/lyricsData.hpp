@@ -0,0 +1,53 @@
+#ifndef __LYRICSDATA_HPP__
+#define __LYRICSDATA_HPP__
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lyricTimeline.hpp"
+#include "mappedFile.hpp"
+#include "stringArena.hpp"
+
+// Everything loaded from one lyrics file. The views in timeline and the tag
+// values point into storage, which is either the mapped .lrc or its mapped
+// .lrcb sidecar, or into arena for text that had to be rewritten (word tags
+// removed) or was streamed in. Nothing else owns lyric text.
+struct LyricsData {
+    MappedFile storage;
+    StringArena arena;
+    LyricTimeline timeline;
+    std::string_view title;
+    std::string_view artist;
+    std::string_view totalLength;
+    size_t maxLyricLength = 0;  // terminal columns of the widest line
+    bool validUtf8 = true;
+};
+
+// Turns LRC lines into timeline entries and tags of a LyricsData. The file
+// loader keeps text as views into the mapped file and applies [offset:] once
+// at the end; streamed lines are copied into the arena and shifted as they come.
+class LrcLineParser {
+    private:
+        LyricsData& data;
+        bool streaming;
+        int64_t offsetUs = 0;
+        std::string scratch;
+
+        int64_t shifted(int64_t) const;
+        std::string_view keep(std::string_view);
+        std::string_view extractWords(std::string_view, int64_t, uint32_t&, uint32_t&);
+    public:
+        LrcLineParser(LyricsData&, bool);
+
+        void parseLine(std::string_view);
+        int64_t offset() const { return offsetUs; }
+};
+
+// Both are safe to call concurrently on different LyricsData objects.
+// On failure error describes what went wrong.
+bool parseLyricsFile(const std::string&, LyricsData&, std::string&);
+
+// Maps a valid .lrcb sidecar if there is one, otherwise parses the
+// file and writes the sidecar for next time.
+bool loadLyricsFile(const std::string&, LyricsData&, std::string&);
+#endif // __LYRICSDATA_HPP__
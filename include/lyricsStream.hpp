@@ -0,0 +1,58 @@
+#ifndef __LYRICSSTREAM_HPP__
+#define __LYRICSSTREAM_HPP__
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "lyricsData.hpp"
+
+// Incremental LRC parser fed with arbitrary byte chunks. A line split across
+// two chunks is held back until its newline arrives. Parsed lines collect in
+// a staging timeline that the player drains while it is running.
+class LrcStreamParser {
+    private:
+        LyricsData staging;
+        LrcLineParser lineParser;
+        std::string partialLine;
+        std::mutex stagingMutex;
+        bool finished = false;
+    public:
+        LrcStreamParser();
+
+        void feed(const char*, size_t);
+        void finish();
+
+        bool drainInto(LyricsData&, size_t);
+        bool isFinished();
+};
+
+// Reads lyrics from stdin ("-") or from a file on a background thread. With
+// follow set the file is tailed: reaching its end only waits for more data.
+class LyricsStream {
+    private:
+        struct State {
+            LrcStreamParser parser;
+            std::atomic<bool> stopping{false};
+        };
+
+        std::shared_ptr<State> state;
+        std::thread reader;
+        bool fromStdin = false;
+
+        static void readLoop(std::shared_ptr<State>, int, bool);
+    public:
+        LyricsStream() = default;
+        ~LyricsStream();
+        LyricsStream(const LyricsStream&) = delete;
+        LyricsStream& operator=(const LyricsStream&) = delete;
+
+        bool open(const std::string&, bool);
+        void stop();
+
+        bool drainInto(LyricsData& data, size_t keepPrefix) { return state->parser.drainInto(data, keepPrefix); }
+        bool isFinished() { return state->parser.isFinished(); }
+        bool readsStdin() const { return fromStdin; }
+};
+#endif // __LYRICSSTREAM_HPP__
@@ -0,0 +1,34 @@
+#ifndef __MAPPEDFILE_HPP__
+#define __MAPPEDFILE_HPP__
+
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file. Regular files are memory mapped; anything
+// that cannot be mapped is read once into a single owned buffer instead.
+class MappedFile {
+    private:
+        const char* mappedData = nullptr;
+        size_t mappedSize = 0;
+        std::string buffer;
+        bool mapped = false;
+        bool opened = false;
+
+        bool map(const std::string&);
+        bool readAll(const std::string&);
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string&);
+        void close();
+
+        bool isOpen() const { return opened; }
+        bool isMapped() const { return mapped; }
+        const char* data() const { return mapped ? mappedData : buffer.data(); }
+        size_t size() const { return mapped ? mappedSize : buffer.size(); }
+        std::string_view view() const { return std::string_view(data(), size()); }
+};
+#endif // __MAPPEDFILE_HPP__
@@ -0,0 +1,84 @@
+#ifndef __RENDERER_HPP__
+#define __RENDERER_HPP__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "cellGrid.hpp"
+#include "frameBuffer.hpp"
+#include "tripleBuffer.hpp"
+
+// Takes the bytes of every frame rendered inline, with the frame's song time
+class FrameSink {
+    public:
+        virtual ~FrameSink() = default;
+        virtual void frame(int64_t, std::string_view) = 0;
+};
+
+// Terminal output on its own thread. The play loop publishes a copy of its
+// cell grid whenever it drew something; the render thread wakes up, waits
+// out the rest of the frame interval and sends the newest copy, so a slow
+// terminal never holds up cue handling. Copies published in between are
+// dropped, not queued.
+//
+// Started inline instead, every published grid is rendered on the spot
+// and folded into a digest with its song time, so two runs can be compared
+// frame for frame, or recorded through a FrameSink.
+class Renderer {
+    public:
+        typedef std::chrono::steady_clock Clock;
+    private:
+        TripleBuffer<std::vector<CellGrid::Cell>> snapshots;
+        // what the terminal shows; only touched by the render thread
+        CellGrid terminal;
+        FrameBuffer frame;
+
+        bool inline_ = false;
+        FrameSink* sink = nullptr;
+        uint64_t frameDigest = 14695981039346656037ull;
+
+        std::thread worker;
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        bool pending = false;
+        bool stopping = false;
+        Clock::duration frameInterval;
+
+        uint64_t published = 0;
+        uint64_t dropped = 0;
+        uint64_t rendered = 0;
+        int64_t frameTimeSumUs = 0;
+        int64_t frameTimeMaxUs = 0;
+
+        void renderLoop();
+        void renderFrame();
+        void addToDigest(const void*, size_t);
+    public:
+        static constexpr int DEFAULT_FPS = 30;
+
+        Renderer() = default;
+        ~Renderer();
+        Renderer(const Renderer&) = delete;
+        Renderer& operator=(const Renderer&) = delete;
+
+        void start(int, int, int fps = DEFAULT_FPS);
+        void startInline(int, int, FrameSink* = nullptr);
+        void publish(const CellGrid&, int64_t);
+        void stop();
+
+        // read once the thread has stopped
+        uint64_t publishedCount() const { return published; }
+        uint64_t droppedCount() const { return dropped; }
+        uint64_t renderedCount() const { return rendered; }
+        int64_t maxFrameTimeUs() const { return frameTimeMaxUs; }
+        int64_t meanFrameTimeUs() const { return rendered ? frameTimeSumUs / static_cast<int64_t>(rendered) : 0; }
+        const FrameBuffer& output() const { return frame; }
+        // of every inline frame and its song time
+        uint64_t digest() const { return frameDigest; }
+        uint64_t cellsRendered() const { return terminal.cellsRendered(); }
+};
+#endif // __RENDERER_HPP__
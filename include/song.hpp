@@ -5,68 +5,181 @@
 #include <vector>
 #include <fstream>
 #include <string>
-#include <regex>
 #include <chrono>
 #include <thread>
 #include <iomanip>
 #include <sstream>
 #include <cstdlib>
-#include <atomic>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
 #include <random>
 #include <stdexcept>
 #include "lyricLine.hpp"
+#include "lrcScanner.hpp"
+#include "lyricsData.hpp"
+#include "lyricsCache.hpp"
+#include "lyricsStream.hpp"
+#include "textWidth.hpp"
 #include "consoleUtils.hpp"
+#include "audioClock.hpp"
+#include "cueSource.hpp"
+#include "durationProbe.hpp"
+#include "deadlineScheduler.hpp"
+#include "frameBuffer.hpp"
+#include "cellGrid.hpp"
+#include "renderer.hpp"
+#include "songClock.hpp"
+#include "allocationCounter.hpp"
 #include "miniaudio.h"
 
+// Playing without a sound card. NullBackend keeps a device (miniaudio's null
+// backend) pacing the audio; Realtime and Fast have no device at all and the
+// play loop reads the engine itself, in step with the wall clock or as fast
+// as it can.
+enum class HeadlessMode {
+    Off,
+    NullBackend,
+    Realtime,
+    Fast
+};
+
+struct SongOptions {
+    bool followLyrics = false;  // tail the lyrics file while playing
+    bool scanDuration = true;   // measure MP3 length in the background
+    int frameRate = Renderer::DEFAULT_FPS;  // most terminal updates per second, 0 for no limit
+    HeadlessMode headless = HeadlessMode::Off;
+    uint64_t randomSeed = 0;    // for the emoji picks, 0 takes one from the time
+};
+
+// What a replay drew: every frame and its song time go into the digest, so
+// equal digests mean the same frames at the same times
+struct ReplaySummary {
+    uint64_t frames = 0;
+    uint64_t digest = 0;
+    int64_t songUs = 0;
+    // heap allocations inside the play loop, counted with COUNT_ALLOCATIONS
+    uint64_t allocations = 0;
+};
+
 class Song {
 private:
-    std::vector<LyricLine> lyrics;
-    std::string title;
-    std::string artist;
-    std::string totalLength;
-
+    SongOptions options;
+    LyricsData lyrics;
+    // set when lyrics come from stdin or a followed file
+    std::unique_ptr<LyricsStream> lyricsStream;
     
     ma_engine audioEngine;
+    // only for HeadlessMode::NullBackend
+    ma_context nullContext;
+    bool nullContextInitialized = false;
+    // the decoder behind music, posts lyric cues from the audio thread
+    CueSource cueSource;
     ma_sound music;
     bool audioInitialized;
 
     std::string musicFile;
-    std::atomic<double> elapsedTime{0.0};
     
-    size_t maxLyricLength = 0;
-    std::chrono::steady_clock::time_point startTime;
+    // song position from the audio cursor, drives every lyric deadline
+    AudioClock clock;
+
+    int64_t totalTimeUs = 0;
+    // exact length from the decoder, 0 until known
+    int64_t durationUs = 0;
+    DurationProbe durationProbe;
 
-    double totalTimeInSeconds;
+    static constexpr int64_t ANIMATION_FRAME_US = 250000;
+    // further behind the audio than this, overdue lines are skipped instead of shown in turn
+    static constexpr int64_t CATCH_UP_US = 1000000;
 
-    std::vector<std::string> emojis = {
+    // sleeps the play loop until its next cue, animation frame or deadline
+    DeadlineScheduler scheduler;
+    // the play loop's time and sleep; ownClock is the one picked for the audio setup
+    std::unique_ptr<SongClock> ownClock;
+    SongClock* songClock = nullptr;
+    // what the play loop draws, handed to the render thread at the end of a pass
+    CellGrid screen;
+    Renderer renderer;
+
+    // music animation shown while no lyric is on screen, advanced by the play loop
+    int64_t animationUntilUs = 0;
+    int64_t nextAnimationFrameUs = LyricTimeline::never;
+    size_t animationFrame = 0;
+
+    // enhanced LRC line being highlighted word by word
+    size_t karaokeLine = LyricTimeline::npos;
+    size_t karaokeBytes = 0;
+    size_t karaokeColumns = 0;
+    std::string_view karaokeEmoji;
+
+    // plain line being typed out; how much is shown follows the song clock
+    size_t typewriterLine = LyricTimeline::npos;
+    size_t typewriterBytes = 0;
+    size_t typewriterChars = 0;
+    size_t typewriterTotalChars = 0;
+    int64_t typewriterStartUs = 0;
+    int64_t typewriterEndUs = 0;
+    std::string_view typewriterEmoji;
+
+    // how late lines appear after their timestamp
+    int64_t lastLatenessUs = 0;
+    int64_t maxLatenessUs = 0;
+    // jumps made after a stall and the lines they skipped
+    size_t catchUps = 0;
+    size_t skippedLines = 0;
+    // made by the last runPlayback() once the loop was running
+    uint64_t loopAllocations = 0;
+
+    std::mt19937_64 rng;
+    static constexpr std::string_view emojis[] = {
     "♪", "♪", "♫"
     };
     
 
 public:
-    Song(const std::string&, const std::string&);
+    // with a clock given, no music is loaded and the console is left alone
+    Song(const std::string&, const std::string&, const SongOptions& = SongOptions(), SongClock* = nullptr);
     ~Song();
     
     bool loadLyricsFromFile(const std::string&);
+    bool openLyricsStream(const std::string&, bool);
     bool loadMusic(const std::string&);
 
     void playMusic();
-    double getCurrentMusicTime(); 
+    int64_t getCurrentMusicTimeUs(); 
+    bool pumpsAudio() const;
 
-    std::string getRandomEmoji();
+    std::string_view getRandomEmoji();
     
-    void displayMusicAnimation(double);
+    void startAnimation(int64_t, int64_t);
+    void stopAnimation();
+    void stepAnimation(int64_t);
+    void displayMusicAnimation(int64_t);
 
-    void displayProgressBar(double, double);
+    void displayProgressBar(int64_t, int64_t);
     
-    double getTotalTimeInSeconds();
+    int64_t getTotalTimeUs();
+    std::string displayTitle() const;
+
+    int64_t availableTimeAfterUs(size_t) const;
     
-    void displayLyricWithEffect(const std::string&, size_t);
+    void startTypewriter(size_t);
+    void stepTypewriter(int64_t);
+    int64_t nextTypewriterTimeUs() const;
+
+    void startKaraokeLine(size_t);
+    void displayKaraokeLine(int64_t);
     
     void displayUpcomingLines(size_t);
 
     void displayPreviousLines(size_t );
+
+    static size_t blankAfter(size_t);
     
     void play();
+    ReplaySummary replay(FrameSink* = nullptr);
+    void runPlayback();
 };
 #endif // __SONG_HPP__
\ No newline at end of file
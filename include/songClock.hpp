@@ -0,0 +1,80 @@
+#ifndef __SONGCLOCK_HPP__
+#define __SONGCLOCK_HPP__
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "audioClock.hpp"
+#include "cueSource.hpp"
+#include "deadlineScheduler.hpp"
+#include "miniaudio.h"
+
+// Where the play loop gets the song position and how it waits for its next
+// deadline. Song picks one to match its audio setup; replays and offline
+// renders inject a VirtualClock, which never sleeps.
+class SongClock {
+    public:
+        virtual ~SongClock() = default;
+
+        virtual void start() = 0;
+        virtual int64_t nowUs() = 0;
+        // returns at deadlineUs on the song clock, or earlier when a cue arrives
+        virtual void waitUntil(int64_t) = 0;
+        // how far past a cue the loop may oversleep before checking the clock itself
+        virtual int64_t cueSlackUs() const { return 0; }
+};
+
+// A sound card or the null device: the audio cursor is the position, and
+// the scheduler sleeps until the deadline or the audio thread's cue
+class DeviceClock : public SongClock {
+    private:
+        AudioClock& clock;
+        DeadlineScheduler& scheduler;
+        CueSource& cues;
+    public:
+        static constexpr int64_t CUE_SLACK_US = 20000;
+
+        DeviceClock(AudioClock&, DeadlineScheduler&, CueSource&);
+
+        void start() override;
+        int64_t nowUs() override { return clock.nowUs(); }
+        void waitUntil(int64_t) override;
+        int64_t cueSlackUs() const override { return CUE_SLACK_US; }
+};
+
+// No device: the engine is read up to each deadline, right away or in step
+// with the wall clock, and the position is exactly what has been read
+class PumpedClock : public SongClock {
+    private:
+        static constexpr ma_uint64 CHUNK_FRAMES = 4096;
+
+        ma_engine* engine;
+        AudioClock& clock;
+        DeadlineScheduler& scheduler;
+        CueSource& cues;
+        bool realtime;
+        std::vector<float> buffer;
+        ma_uint64 pumpedFrames = 0;
+        std::chrono::steady_clock::time_point started;
+    public:
+        PumpedClock(ma_engine*, AudioClock&, DeadlineScheduler&, CueSource&, bool);
+
+        void start() override;
+        int64_t nowUs() override { return clock.framesToUs(pumpedFrames); }
+        void waitUntil(int64_t) override;
+};
+
+// Jumps straight to every deadline. The same lyrics give the same sequence
+// of frames on every run, however fast the machine is.
+class VirtualClock : public SongClock {
+    private:
+        int64_t timeUs = 0;
+        uint64_t waits = 0;
+    public:
+        void start() override;
+        int64_t nowUs() override { return timeUs; }
+        void waitUntil(int64_t) override;
+
+        uint64_t waitCount() const { return waits; }
+};
+#endif // __SONGCLOCK_HPP__
@@ -0,0 +1,36 @@
+#ifndef __SPSCQUEUE_HPP__
+#define __SPSCQUEUE_HPP__
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock-free queue for exactly one producer thread and one
+// consumer thread, safe to use from the audio callback: it never
+// allocates or blocks. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    private:
+        static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+        T items[Capacity];
+        alignas(64) std::atomic<size_t> head{0};  // next slot to read, owned by the consumer
+        alignas(64) std::atomic<size_t> tail{0};  // next slot to write, owned by the producer
+    public:
+        // false when full; the item is dropped
+        bool push(const T& item) {
+            size_t write = tail.load(std::memory_order_relaxed);
+            if (write - head.load(std::memory_order_acquire) == Capacity) return false;
+            items[write & (Capacity - 1)] = item;
+            tail.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& item) {
+            size_t read = head.load(std::memory_order_relaxed);
+            if (read == tail.load(std::memory_order_acquire)) return false;
+            item = items[read & (Capacity - 1)];
+            head.store(read + 1, std::memory_order_release);
+            return true;
+        }
+};
+#endif // __SPSCQUEUE_HPP__
@@ -0,0 +1,45 @@
+#ifndef __STRINGARENA_HPP__
+#define __STRINGARENA_HPP__
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocator for text that has no backing file, e.g. lyric lines with
+// inline tags removed. Views it returns stay valid until the arena dies;
+// everything is released at once.
+class StringArena {
+    private:
+        // blocks double from the first size up to the largest, so a short song stays small
+        static const size_t FIRST_BLOCK_SIZE = 512;
+        static const size_t BLOCK_SIZE = 16 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        // open addressing, a null view marks a free slot
+        std::vector<std::string_view> internSlots;
+        size_t internedCount = 0;
+        char* cursor = nullptr;
+        size_t remaining = 0;
+        size_t nextBlockSize = FIRST_BLOCK_SIZE;
+        size_t usedBytes = 0;
+        size_t reservedBytes = 0;
+        size_t internHits = 0;
+
+        void growInternTable();
+    public:
+        StringArena() = default;
+        StringArena(const StringArena&) = delete;
+        StringArena& operator=(const StringArena&) = delete;
+
+        char* allocate(size_t);
+        std::string_view store(std::string_view);
+        std::string_view intern(std::string_view);
+        void clear();
+
+        size_t bytesUsed() const { return usedBytes; }
+        size_t bytesReserved() const { return reservedBytes; }
+        size_t blockCount() const { return blocks.size(); }
+        size_t indexBytes() const { return internSlots.capacity() * sizeof(std::string_view); }
+        size_t sharedStrings() const { return internHits; }
+};
+#endif // __STRINGARENA_HPP__
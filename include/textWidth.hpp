@@ -0,0 +1,21 @@
+#ifndef __TEXTWIDTH_HPP__
+#define __TEXTWIDTH_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// UTF-8 validation and terminal column widths, used once at load time so
+// layout never rescans lyric text while playing. Pure ASCII runs are
+// skipped 16 bytes at a time with SSE2 where it is available.
+class TextWidth {
+    private:
+        TextWidth() = delete;
+        ~TextWidth() = delete;
+    public:
+        static bool isValidUtf8(std::string_view);
+        static size_t columns(std::string_view);
+        static int codePointColumns(uint32_t);
+        static size_t nextCodePoint(std::string_view, size_t, uint32_t&);
+};
+#endif // __TEXTWIDTH_HPP__
@@ -0,0 +1,50 @@
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size pool with one task deque per worker. A worker pops the newest
+// task from its own deque and, when that is empty, steals the oldest task
+// from the other workers.
+class ThreadPool {
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable allDone;
+        std::atomic<size_t> queuedTasks{0};
+        std::atomic<size_t> pendingTasks{0};
+        std::atomic<size_t> nextQueue{0};
+        std::atomic<size_t> stolen{0};
+        bool stopping = false;
+
+        void workerLoop(size_t);
+        bool popLocal(size_t, std::function<void()>&);
+        bool steal(size_t, std::function<void()>&);
+    public:
+        explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()>);
+        void wait();
+
+        size_t size() const { return workers.size(); }
+        size_t stolenTasks() const { return stolen.load(); }
+};
+#endif // __THREADPOOL_HPP__
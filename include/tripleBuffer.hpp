@@ -0,0 +1,46 @@
+#ifndef __TRIPLEBUFFER_HPP__
+#define __TRIPLEBUFFER_HPP__
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-off of the latest value from one producer thread to one
+// consumer thread. The producer fills back() and publishes it; the consumer
+// takes whatever was published last. A value published over one the
+// consumer never took is dropped, never queued. Neither side blocks.
+template <typename T>
+class TripleBuffer {
+    private:
+        static constexpr uint8_t INDEX = 3;
+        static constexpr uint8_t FRESH = 4;  // the shared slot holds a value not taken yet
+
+        T slots[3];
+        alignas(64) std::atomic<uint8_t> shared{1};
+        alignas(64) uint8_t writing = 0;  // owned by the producer
+        alignas(64) uint8_t reading = 2;  // owned by the consumer
+    public:
+        // Only before both threads start
+        void fill(const T& value) {
+            for (T& slot : slots) slot = value;
+        }
+
+        T& back() { return slots[writing]; }
+
+        // true when the value it replaces was never taken
+        bool publish() {
+            uint8_t previous = shared.exchange(writing | FRESH, std::memory_order_acq_rel);
+            writing = previous & INDEX;
+            return (previous & FRESH) != 0;
+        }
+
+        // false when nothing new was published since the last take
+        bool take() {
+            if ((shared.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+            uint8_t previous = shared.exchange(reading, std::memory_order_acq_rel);
+            reading = previous & INDEX;
+            return true;
+        }
+
+        const T& front() const { return slots[reading]; }
+};
+#endif // __TRIPLEBUFFER_HPP__
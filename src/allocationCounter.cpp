@@ -0,0 +1,62 @@
+#include "allocationCounter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef COUNT_ALLOCATIONS
+
+static atomic<uint64_t> allocations{0};
+
+static void* countedAllocation(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+static void* countedAlignedAllocation(size_t size, align_val_t alignment) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    void* memory = aligned_alloc(align, (max<size_t>(size, 1) + align - 1) / align * align);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+void* operator new(size_t size) { return countedAllocation(size); }
+void* operator new[](size_t size) { return countedAllocation(size); }
+void* operator new(size_t size, align_val_t alignment) { return countedAlignedAllocation(size, alignment); }
+void* operator new[](size_t size, align_val_t alignment) { return countedAlignedAllocation(size, alignment); }
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try { return countedAllocation(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    try { return countedAllocation(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, const nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* memory, const nothrow_t&) noexcept { free(memory); }
+
+uint64_t AllocationCounter::count() {
+    return allocations.load(memory_order_relaxed);
+}
+
+#else
+
+uint64_t AllocationCounter::count() {
+    return 0;
+}
+
+#endif
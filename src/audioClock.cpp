@@ -0,0 +1,66 @@
+#include "audioClock.hpp"
+#include <algorithm>
+
+using namespace std;
+
+bool AudioClock::attach(ma_sound* target) {
+    ma_uint32 rate = 0;
+    if (ma_sound_get_data_format(target, NULL, NULL, &rate, NULL, 0) != MA_SUCCESS || rate == 0) {
+        return false;
+    }
+    sound = target;
+    sampleRate = rate;
+    return true;
+}
+
+// Call right after the sound is started; the wall clock used for
+// interpolation and drift counts from here
+void AudioClock::start() {
+    startTime = Clock::now();
+    anchorTime = startTime;
+    anchorUs = 0;
+    lastFrames = 0;
+    lastUs = 0;
+    drift = ClockDriftStats();
+}
+
+int64_t AudioClock::framesToUs(ma_uint64 frames) const {
+    if (sampleRate == 0) return 0;
+    // split so frames * 1000000 cannot overflow on long sounds
+    return static_cast<int64_t>(frames / sampleRate) * 1000000 +
+           static_cast<int64_t>((frames % sampleRate) * 1000000 / sampleRate);
+}
+
+ma_uint64 AudioClock::usToFrames(int64_t timeUs) const {
+    if (timeUs <= 0) return 0;
+    ma_uint64 us = static_cast<ma_uint64>(timeUs);
+    return (us / 1000000) * sampleRate + (us % 1000000) * sampleRate / 1000000;
+}
+
+int64_t AudioClock::nowUs() {
+    Clock::time_point now = Clock::now();
+    int64_t wallUs = chrono::duration_cast<chrono::microseconds>(now - startTime).count();
+    if (sound == nullptr) return wallUs;
+
+    ma_uint64 frames = 0;
+    if (ma_sound_get_cursor_in_pcm_frames(sound, &frames) == MA_SUCCESS && frames != lastFrames) {
+        lastFrames = frames;
+        anchorUs = framesToUs(frames);
+        anchorTime = now;
+
+        drift.lastUs = wallUs - anchorUs;
+        drift.maxAbsUs = max(drift.maxAbsUs, std::abs(drift.lastUs));
+        drift.sumAbsUs += std::abs(drift.lastUs);
+        drift.samples++;
+    }
+
+    int64_t sinceAnchorUs = chrono::duration_cast<chrono::microseconds>(now - anchorTime).count();
+    // frames == 0 before the device has produced anything: the song has not started yet
+    if (!ma_sound_at_end(sound)) {
+        sinceAnchorUs = lastFrames == 0 ? 0 : min(sinceAnchorUs, MAX_INTERPOLATION_US);
+    }
+
+    // a fresh cursor may land slightly behind the interpolated time; never go backwards
+    lastUs = max(lastUs, anchorUs + sinceAnchorUs);
+    return lastUs;
+}
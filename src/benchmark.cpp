@@ -0,0 +1,308 @@
+#include "benchmark.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <regex>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+#include <filesystem>
+#include "lyricLine.hpp"
+#include "lrcScanner.hpp"
+#include "lyricsData.hpp"
+#include "lyricsCache.hpp"
+#include "consoleUtils.hpp"
+
+using namespace std;
+
+struct ParsedLyrics {
+    vector<LyricLine> lyrics;
+    deque<string> texts;
+    string title;
+    string artist;
+    string totalLength;
+};
+
+// The loader as it was before the scanner, kept as the reference path
+static void parseWithRegex(const vector<string>& lines, ParsedLyrics& out) {
+    regex lrcRegex(R"(\[(\d+:\d+\.\d+)\](.*))");
+    regex lengthRegex(R"(\[length: (\d+:\d+)\])");
+    regex tagRegex(R"(\[(\w+):\s*(.*)\])");
+    regex timeRegex(R"((\d+):(\d+)\.(\d+))");
+    smatch matches;
+
+    for (const string& line : lines) {
+        if (regex_match(line, matches, lengthRegex)) {
+            out.totalLength = matches[1].str();
+            continue;
+        }
+        if (regex_match(line, matches, tagRegex)) {
+            if (matches[1] == "title" || matches[1] == "ti") out.title = matches[2].str();
+            else if (matches[1] == "artist" || matches[1] == "ar") out.artist = matches[2].str();
+            continue;
+        }
+        if (regex_match(line, matches, lrcRegex)) {
+            string timeStr = matches[1].str();
+            string lyricText = matches[2].str();
+
+            // the old parseTime built its regex on every call
+            regex perCallRegex(R"((\d+):(\d+)\.(\d+))");
+            smatch timeMatches;
+            double time = 0.0;
+            if (regex_match(timeStr, timeMatches, perCallRegex)) {
+                time = stoi(timeMatches[1].str()) * 60.0 + stoi(timeMatches[2].str()) +
+                       stoi(timeMatches[3].str()) / 100.0;
+            }
+            out.texts.push_back(lyricText);
+            out.lyrics.emplace_back(llround(time * 1e6), out.texts.back());
+        }
+    }
+}
+
+static void parseWithScanner(const vector<string>& lines, ParsedLyrics& out) {
+    for (const string& line : lines) {
+        LrcScanResult scanned = LrcScanner::scanLine(line);
+
+        if (scanned.kind == LrcLineKind::Tag) {
+            if (scanned.name == "length") out.totalLength = string(scanned.value);
+            else if (scanned.name == "title" || scanned.name == "ti") out.title = string(scanned.value);
+            else if (scanned.name == "artist" || scanned.name == "ar") out.artist = string(scanned.value);
+        }
+        else if (scanned.kind == LrcLineKind::Timestamp) {
+            string_view tags = scanned.name;
+            while (!tags.empty()) {
+                int64_t timeUs = 0;
+                LyricLine::parseTime(LrcScanner::nextTime(tags), timeUs);
+                out.lyrics.emplace_back(timeUs, scanned.value);
+            }
+        }
+    }
+}
+
+static vector<string> syntheticLines(size_t count) {
+    vector<string> lines = {"[ti:Synthetic]", "[ar:Benchmark]", "[length: 66:40]"};
+    for (size_t i = 0; i < count; i++) {
+        ostringstream line;
+        size_t centis = i * 200;
+        line << '[' << setfill('0') << setw(2) << centis / 6000 << ':'
+             << setw(2) << (centis / 100) % 60 << '.' << setw(2) << centis % 100 << ']';
+        if (i % 10 != 9) {
+            line << "Synthetic lyric line number " << i << " with some words";
+        }
+        lines.push_back(line.str());
+    }
+    return lines;
+}
+
+template <typename Parser>
+static double microsPerParse(const vector<string>& lines, Parser parser, int iterations, size_t& parsed) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        ParsedLyrics out;
+        parser(lines, out);
+        parsed = out.lyrics.size();
+    }
+    auto elapsed = chrono::steady_clock::now() - start;
+    return chrono::duration<double, micro>(elapsed).count() / iterations;
+}
+
+static void compare(const string& name, const vector<string>& lines) {
+    size_t regexLines = 0;
+    size_t scannerLines = 0;
+    double regexUs = microsPerParse(lines, parseWithRegex, 3, regexLines);
+    double scannerUs = microsPerParse(lines, parseWithScanner, 200, scannerLines);
+
+    cout << name << " (" << lines.size() << " lines)" << endl;
+    cout << fixed << setprecision(1)
+         << "  regex:   " << setw(10) << regexUs << " us/parse, " << regexLines << " lyric lines" << endl
+         << "  scanner: " << setw(10) << scannerUs << " us/parse, " << scannerLines << " lyric lines" << endl
+         << "  speedup: " << setw(10) << regexUs / scannerUs << "x" << endl;
+}
+
+int Benchmark::parser(const vector<string>& files) {
+    compare("synthetic", syntheticLines(2000));
+
+    for (const string& filename : files) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: The file could not be opened: " << filename << endl;
+            return 1;
+        }
+        vector<string> lines;
+        string line;
+        while (getline(file, line)) lines.push_back(line);
+        compare(filename, lines);
+    }
+    return 0;
+}
+
+template <typename Loader>
+static double microsPerLoad(Loader loader, int iterations) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        LyricsData data;
+        if (!loader(data)) return -1.0;
+    }
+    auto elapsed = chrono::steady_clock::now() - start;
+    return chrono::duration<double, micro>(elapsed).count() / iterations;
+}
+
+int Benchmark::cache(const vector<string>& files) {
+    vector<string> targets = files;
+    if (targets.empty()) {
+        string synthetic = (filesystem::temp_directory_path() / "lyrics-bench.lrc").string();
+        ofstream out(synthetic, ios::trunc);
+        for (const string& line : syntheticLines(2000)) out << line << '\n';
+        targets.push_back(synthetic);
+    }
+
+    for (const string& filename : targets) {
+        error_code ec;
+        filesystem::remove(LyricsCache::sidecarPath(filename), ec);
+
+        string error;
+        auto parse = [&](LyricsData& data) { return parseLyricsFile(filename, data, error); };
+        auto loadSidecar = [&](LyricsData& data) { return LyricsCache::load(filename, data); };
+
+        // first touch of the file in this process, including the page faults on the mapping
+        double coldUs = microsPerLoad(parse, 1);
+        double warmUs = microsPerLoad(parse, 200);
+
+        LyricsData parsed;
+        if (coldUs < 0 || !parseLyricsFile(filename, parsed, error) || !LyricsCache::write(filename, parsed)) {
+            cerr << "Error: could not parse or cache " << filename << " " << error << endl;
+            return 1;
+        }
+        double sidecarUs = microsPerLoad(loadSidecar, 200);
+
+        cout << filename << " (" << parsed.timeline.size() << " lyric lines)" << endl;
+        cout << fixed << setprecision(1)
+             << "  cold parse:   " << setw(10) << coldUs << " us" << endl
+             << "  warm parse:   " << setw(10) << warmUs << " us" << endl
+             << "  sidecar load: " << setw(10) << sidecarUs << " us" << endl;
+    }
+    return 0;
+}
+
+struct TextFootprint {
+    size_t songs = 0;
+    size_t lines = 0;
+    size_t ownedBytes = 0;
+    size_t ownedAllocations = 0;
+    size_t arenaUsed = 0;
+    size_t arenaBytes = 0;
+    size_t arenaAllocations = 0;
+    size_t sharedLines = 0;
+};
+
+// Bookkeeping malloc keeps next to every allocation
+static const size_t MALLOC_OVERHEAD = 2 * sizeof(size_t);
+
+// Heap taken by one std::string holding text, as each LyricLine and tag used to own
+static void countOwned(string_view text, TextFootprint& footprint) {
+    string owned(text);
+    footprint.ownedBytes += sizeof(string);
+    if (owned.capacity() > string().capacity()) {
+        footprint.ownedBytes += owned.capacity() + 1 + MALLOC_OVERHEAD;
+        footprint.ownedAllocations++;
+    }
+}
+
+// Parses the lines the way streamed lyrics are, so every string goes through the arena
+static void measureSong(const vector<string>& lines, TextFootprint& footprint) {
+    LyricsData data;
+    LrcLineParser lineParser(data, true);
+    for (const string& line : lines) lineParser.parseLine(line);
+
+    const LyricTimeline& timeline = data.timeline;
+    for (size_t i = 0; i < timeline.size(); i++) {
+        countOwned(timeline.textAt(i), footprint);
+        footprint.arenaBytes += sizeof(string_view);
+    }
+    for (string_view tag : {data.title, data.artist, data.totalLength}) {
+        countOwned(tag, footprint);
+        footprint.arenaBytes += sizeof(string_view);
+    }
+
+    footprint.songs++;
+    footprint.lines += timeline.size();
+    footprint.arenaUsed += data.arena.bytesUsed();
+    size_t arenaAllocations = data.arena.blockCount() + (data.arena.indexBytes() > 0 ? 1 : 0);
+    footprint.arenaBytes += data.arena.bytesReserved() + data.arena.indexBytes() + arenaAllocations * MALLOC_OVERHEAD;
+    footprint.arenaAllocations += arenaAllocations;
+    footprint.sharedLines += data.arena.sharedStrings();
+}
+
+// A song whose four line chorus comes back four times
+static vector<string> syntheticSong(size_t song) {
+    vector<string> lines = {"[ti:Synthetic song " + to_string(song) + "]", "[ar:Benchmark]", "[length: 3:30]"};
+    for (size_t i = 0; i < 48; i++) {
+        size_t centis = 1000 + i * 400;
+        ostringstream line;
+        line << '[' << setfill('0') << setw(2) << centis / 6000 << ':'
+             << setw(2) << (centis / 100) % 60 << '.' << setw(2) << centis % 100 << ']';
+        if (i % 12 < 4) line << "Chorus line " << i % 12 << " that everybody sings along to";
+        else line << "Verse " << i / 12 << " line " << i % 12 << " of song " << song;
+        lines.push_back(line.str());
+    }
+    return lines;
+}
+
+int Benchmark::memory(const vector<string>& files) {
+    TextFootprint footprint;
+
+    if (files.empty()) {
+        // a playlist of 500 songs
+        for (size_t song = 0; song < 500; song++) measureSong(syntheticSong(song), footprint);
+    }
+    for (const string& filename : files) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: The file could not be opened: " << filename << endl;
+            return 1;
+        }
+        vector<string> lines;
+        string line;
+        while (getline(file, line)) lines.push_back(line);
+        measureSong(lines, footprint);
+    }
+
+    cout << footprint.songs << " songs, " << footprint.lines << " lyric lines, "
+         << footprint.sharedLines << " repeated strings shared" << endl
+         << "  owned strings: " << setw(10) << footprint.ownedBytes << " bytes, "
+         << footprint.ownedAllocations << " allocations" << endl
+         << "  arena:         " << setw(10) << footprint.arenaBytes << " bytes, "
+         << footprint.arenaAllocations << " allocations (" << footprint.arenaUsed << " bytes of text)" << endl;
+    return 0;
+}
+
+// Average cost of the console calls made at startup and between songs.
+// Run it in the terminal to measure; the screen is cleared many times.
+int Benchmark::terminal(const vector<string>&) {
+    const int rounds = 200;
+    int width = ConsoleUtils::consoleWidth;
+    int height = ConsoleUtils::consoleHeight;
+
+    auto timeCall = [&](auto call) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) call();
+        cout << flush;
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / rounds;
+    };
+    double clearUs = timeCall([] { ConsoleUtils::clearConsole(); });
+    double resizeUs = timeCall([&] { ConsoleUtils::setConsoleSize(width, height); });
+    double titleUs = timeCall([] { ConsoleUtils::setConsoleTitle("Benchmark"); });
+    ConsoleUtils::clearConsole();
+
+    const TerminalCapabilities& terminal = ConsoleUtils::capabilities;
+    cout << "Terminal: " << (terminal.isTerminal ? "tty" : "not a tty")
+         << (terminal.ansi ? ", escape sequences" : "")
+         << (terminal.windowTitle ? ", titles" : "")
+         << (terminal.windowResize ? ", window resizing" : "") << endl
+         << fixed << setprecision(1)
+         << "  clear:  " << setw(8) << clearUs << " us" << endl
+         << "  resize: " << setw(8) << resizeUs << " us" << endl
+         << "  title:  " << setw(8) << titleUs << " us" << endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "castWriter.hpp"
+#include "textWidth.hpp"
+
+using namespace std;
+
+// The frames that follow assume a cleared screen with the cursor hidden
+bool CastWriter::open(const string& path, int width, int height, string_view title) {
+    file.open(path, ios::binary | ios::trunc);
+    if (!file) return false;
+
+    file << "{\"version\": 2, \"width\": " << width << ", \"height\": " << height << ", \"title\": ";
+    writeString(title);
+    file << "}\n";
+    frame(0, "\033[?25l\033[H\033[2J");
+    return static_cast<bool>(file);
+}
+
+void CastWriter::close(int64_t timeUs) {
+    if (!file.is_open()) return;
+    frame(timeUs, "\033[?25h");
+    file.close();
+}
+
+// Frames that changed nothing are left out
+void CastWriter::frame(int64_t timeUs, string_view bytes) {
+    if (bytes.empty()) return;
+
+    file << '[';
+    writeTime(timeUs);
+    file << ", \"o\", ";
+    writeString(bytes);
+    file << "]\n";
+    events++;
+}
+
+// Seconds with microsecond precision, without going through floating point
+void CastWriter::writeTime(int64_t timeUs) {
+    timeUs = max<int64_t>(0, timeUs);
+    char digits[8];
+    int64_t fraction = timeUs % 1000000;
+    for (int i = 5; i >= 0; i--) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    file << timeUs / 1000000 << '.';
+    file.write(digits, 6);
+}
+
+// A JSON string; valid UTF-8 is passed through, each invalid byte becomes
+// U+FFFD and control characters are escaped
+void CastWriter::writeString(string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    file << '"';
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint32_t codePoint;
+        size_t length = TextWidth::nextCodePoint(text, pos, codePoint);
+        if (length == 1 && codePoint == 0xFFFD) {
+            file << "\xEF\xBF\xBD";
+        }
+        else if (codePoint == '"' || codePoint == '\\') {
+            file << '\\' << static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x20 || codePoint == 0x7f) {
+            file << "\\u00" << hex[codePoint >> 4] << hex[codePoint & 0xf];
+        }
+        else {
+            file.write(text.data() + pos, length);
+        }
+        pos += length;
+    }
+    file << '"';
+}
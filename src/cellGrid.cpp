@@ -0,0 +1,205 @@
+#include "cellGrid.hpp"
+#include "consoleUtils.hpp"
+#include "textWidth.hpp"
+#include <cstring>
+
+using namespace std;
+
+static CellGrid::Cell blankCell() {
+    CellGrid::Cell cell = {};
+    cell.length = 1;
+    cell.bytes[0] = ' ';
+    cell.color = RESET;
+    return cell;
+}
+
+static bool isBlank(const CellGrid::Cell& cell) {
+    return cell.length == 1 && cell.bytes[0] == ' ';
+}
+
+// Both grids start out as a cleared screen, so call it right after clearing
+// the console; it is the only way the diff baseline is reset
+void CellGrid::resize(int columns, int rows) {
+    width = max(0, columns);
+    height = max(0, rows);
+    back.assign(static_cast<size_t>(width) * height, blankCell());
+    front = back;
+    cursorX = cursorY = 0;
+    terminalColor = terminalX = terminalY = -1;
+}
+
+void CellGrid::setCells(const vector<Cell>& cells) {
+    if (cells.size() == back.size()) back = cells;
+}
+
+bool CellGrid::takeChanges() {
+    bool changes = drawn;
+    drawn = false;
+    return changes;
+}
+
+void CellGrid::moveCursor(int x, int y) {
+    cursorX = x;
+    cursorY = y;
+}
+
+void CellGrid::setTextColor(int textColor) {
+    color = textColor;
+}
+
+// Writes one code point of `columns` width at the cursor. Anything past the
+// grid edge is dropped rather than wrapped.
+void CellGrid::put(string_view bytes, int columns) {
+    drawn = true;
+    if (cursorY < 0 || cursorY >= height || cursorX < 0 || cursorX + columns > width) {
+        cursorX += columns;
+        return;
+    }
+    Cell* row = &back[static_cast<size_t>(cursorY) * width];
+
+    if (columns == 0) {
+        // combining marks and the like join the character before them
+        int x = cursorX - 1;
+        if (x >= 0 && row[x].length == 0 && x > 0) x--;
+        if (x >= 0 && row[x].length + bytes.size() <= sizeof(row[x].bytes)) {
+            memcpy(row[x].bytes + row[x].length, bytes.data(), bytes.size());
+            row[x].length += static_cast<uint8_t>(bytes.size());
+        }
+        return;
+    }
+
+    // never leave half of a wide character behind
+    if (row[cursorX].length == 0 && cursorX > 0) row[cursorX - 1] = blankCell();
+    int after = cursorX + columns;
+    if (after < width && row[after].length == 0) row[after] = blankCell();
+
+    Cell cell = {};
+    cell.length = static_cast<uint8_t>(min(bytes.size(), sizeof(cell.bytes)));
+    memcpy(cell.bytes, bytes.data(), cell.length);
+    // the colour of a space does not show, so it never makes a cell differ
+    cell.color = isBlank(cell) ? RESET : color;
+    row[cursorX] = cell;
+    if (columns == 2) {
+        Cell second = {};
+        second.color = cell.color;
+        row[cursorX + 1] = second;
+    }
+    cursorX += columns;
+}
+
+CellGrid& CellGrid::operator<<(string_view text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint32_t codePoint;
+        size_t length = TextWidth::nextCodePoint(text, pos, codePoint);
+        // control characters would move the real cursor
+        if (codePoint >= 0x20 && (codePoint < 0x7F || codePoint >= 0xA0)) {
+            put(text.substr(pos, length), TextWidth::codePointColumns(codePoint));
+        }
+        pos += length;
+    }
+    return *this;
+}
+
+void CellGrid::spaces(size_t count) {
+    for (size_t i = 0; i < count; i++) put(" ", 1);
+}
+
+void CellGrid::repeat(string_view text, size_t count) {
+    for (size_t i = 0; i < count; i++) *this << text;
+}
+
+// Non-negative values, zero padded to width digits
+void CellGrid::number(int64_t value, int digitsWidth) {
+    char digits[24];
+    int count = 0;
+    uint64_t rest = value < 0 ? 0 : static_cast<uint64_t>(value);
+    do {
+        digits[count++] = static_cast<char>('0' + rest % 10);
+        rest /= 10;
+    } while (rest > 0);
+    while (count < digitsWidth && count < static_cast<int>(sizeof(digits))) digits[count++] = '0';
+
+    while (count > 0) {
+        put(string_view(&digits[--count], 1), 1);
+    }
+}
+
+void CellGrid::drawBox(int x1, int x2, int y1, int y2, int boxColor) {
+    setTextColor(boxColor);
+    for (int i = x1; i <= x2; i++) {
+        moveCursor(i, y1); *this << "─";
+        moveCursor(i, y2); *this << "─";
+    }
+    for (int i = y1; i <= y2; i++) {
+        moveCursor(x1, i); *this << "│";
+        moveCursor(x2, i); *this << "│";
+    }
+    moveCursor(x1, y1); *this << "┌";
+    moveCursor(x1, y2); *this << "└";
+    moveCursor(x2, y1); *this << "┐";
+    moveCursor(x2, y2); *this << "┘";
+    setTextColor(RESET);
+}
+
+// Sends the changed cells of one row. A short run of unchanged cells between
+// two changes is written again when that is cheaper than a cursor move.
+void CellGrid::sendRow(int y, FrameBuffer& out) {
+    Cell* backRow = &back[static_cast<size_t>(y) * width];
+    Cell* frontRow = &front[static_cast<size_t>(y) * width];
+
+    for (int x = 0; x < width; x++) {
+        if (memcmp(&backRow[x], &frontRow[x], sizeof(Cell)) == 0) continue;
+
+        // the second half of a wide character is sent as the character itself
+        int start = (backRow[x].length == 0 && x > 0) ? x - 1 : x;
+
+        if (terminalY != y || terminalX != start) {
+            int gap = start - terminalX;
+            bool refill = terminalY == y && terminalX >= 0 && gap > 0 && gap <= 4;
+            for (int i = terminalX; refill && i < start; i++) {
+                const Cell& cell = backRow[i];
+                refill = cell.length == 1 && (isBlank(cell) || cell.color == terminalColor) &&
+                         (i + 1 >= width || backRow[i + 1].length != 0);
+            }
+            if (refill) {
+                for (int i = terminalX; i < start; i++) out << backRow[i].bytes[0];
+            }
+            else {
+                out.moveCursor(start, y);
+            }
+        }
+
+        const Cell& cell = backRow[start];
+        int columns = (start + 1 < width && backRow[start + 1].length == 0) ? 2 : 1;
+        if (cell.length == 0) {
+            // a lone second half at the row start
+            if (terminalColor == -1) { out.setTextColor(RESET); terminalColor = RESET; }
+            out << ' ';
+        }
+        else {
+            if (!isBlank(cell) && cell.color != terminalColor) {
+                out.setTextColor(cell.color);
+                terminalColor = cell.color;
+            }
+            out << string_view(cell.bytes, cell.length);
+        }
+        memcpy(&frontRow[start], &backRow[start], columns * sizeof(Cell));
+        cellsSent++;
+
+        x = start + columns - 1;
+        terminalY = y;
+        // at the last column the terminal holds the cursor in a pending wrap
+        terminalX = start + columns < width ? start + columns : -1;
+    }
+}
+
+void CellGrid::render(FrameBuffer& out) {
+    size_t rowBytes = static_cast<size_t>(width) * sizeof(Cell);
+    for (int y = 0; y < height; y++) {
+        size_t offset = static_cast<size_t>(y) * width;
+        if (memcmp(&back[offset], &front[offset], rowBytes) != 0) {
+            sendRow(y, out);
+        }
+    }
+}
@@ -1,4 +1,6 @@
 #include "consoleUtils.hpp"
+#include <cstdlib>
+#include <cstring>
 
 using namespace std;
 
@@ -7,6 +9,37 @@ HANDLE ConsoleUtils::hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
 static UINT originalCP = 0;
 #endif
 
+const TerminalCapabilities ConsoleUtils::capabilities = ConsoleUtils::detectTerminal();
+
+TerminalCapabilities ConsoleUtils::detectTerminal() {
+    TerminalCapabilities found;
+    #ifdef _WIN32
+        DWORD mode = 0;
+        found.isTerminal = GetConsoleMode(hConsole, &mode) != 0;
+        // the play loop writes its frames as escape sequences
+        found.ansi = found.isTerminal &&
+                     SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+        found.windowTitle = found.isTerminal;
+        found.windowResize = found.isTerminal;
+    #else
+        found.isTerminal = isatty(STDOUT_FILENO) == 1;
+        // output to a file or pipe still gets escapes, as clear used to write them
+        const char* term = getenv("TERM");
+        if (term == nullptr || term[0] == '\0' || strcmp(term, "dumb") == 0) return found;
+        found.ansi = true;
+
+        static const char* const titled[] = {
+            "xterm", "rxvt", "screen", "tmux", "alacritty", "kitty", "foot", "wezterm",
+            "konsole", "gnome", "vte", "putty", "st-"
+        };
+        for (const char* prefix : titled) {
+            if (strncmp(term, prefix, strlen(prefix)) == 0) found.windowTitle = true;
+        }
+        found.windowResize = strncmp(term, "xterm", 5) == 0;
+    #endif
+    return found;
+}
+
 int ConsoleUtils::consoleWidth = 80;  
 int ConsoleUtils::consoleHeight = 25;  
 
@@ -24,7 +57,10 @@ void ConsoleUtils::clearConsole() {
         FillConsoleOutputAttribute(hConsole, csbi.wAttributes, cellCount, homeCoords, &count);
         SetConsoleCursorPosition(hConsole, homeCoords);
     #else
-        system("clear");
+        // home, erase the screen and the scrollback, as clear does
+        if (capabilities.ansi) {
+            cout << "\033[H\033[2J\033[3J" << flush;
+        }
     #endif
 }
 
@@ -78,11 +114,13 @@ void ConsoleUtils::setConsoleSize(int width, int height) {
     }
     
 #ifdef _WIN32
-    string command = "mode con: cols=" + to_string(width) + 
-                         " lines=" + to_string(height);
-    
-    int result = system(command.c_str());
-    if (result != 0) {
+    COORD bufferSize = { static_cast<SHORT>(width), static_cast<SHORT>(height) };
+    SMALL_RECT window = { 0, 0, static_cast<SHORT>(width - 1), static_cast<SHORT>(height - 1) };
+    // the buffer can never be smaller than the window, so shrink the window first
+    SMALL_RECT smallest = { 0, 0, 1, 1 };
+    SetConsoleWindowInfo(hConsole, TRUE, &smallest);
+
+    if (!SetConsoleScreenBufferSize(hConsole, bufferSize) || !SetConsoleWindowInfo(hConsole, TRUE, &window)) {
         cerr << "error resizing the console: " << endl;
     }
     else{
@@ -97,15 +135,13 @@ void ConsoleUtils::setConsoleSize(int width, int height) {
     w.ws_xpixel = 0;
     w.ws_ypixel = 0;
 
-    if (ioctl(STDOUT_FILENO, TIOCSWINSZ, &w) == -1) {
-        perror("ioctl failed");
-
+    // the ioctl only tells the kernel; the emulator window is asked separately
+    if (capabilities.windowResize) {
         cout << "\033[8;" << height << ";" << width << "t" << flush;
-        string command = "command -v resize > /dev/null 2>&1 && resize -s " +
-                         to_string(height) + " " + to_string(width) +
-                         " > /dev/null 2>&1";
-        int result = system(command.c_str());
-        if (result != 0) {
+    }
+
+    if (ioctl(STDOUT_FILENO, TIOCSWINSZ, &w) == -1) {
+        if (!capabilities.windowResize) {
             cerr << "error resizing console" << endl;
         }
     } 
@@ -127,6 +163,7 @@ void ConsoleUtils::setConsoleCursorVisibility(bool visible, int size) {
         lpCursor.dwSize = static_cast<DWORD>(size);
         SetConsoleCursorInfo(hConsole, &lpCursor);
     #else
+        if (!capabilities.ansi) return;
         if (visible) {
             cout << "\033[?25h";  // Show
         } else {
@@ -159,7 +196,9 @@ void ConsoleUtils::setConsoleTitle(const string& title) {
     #ifdef _WIN32
         SetConsoleTitleW(wstring(title.begin(), title.end()).c_str());
     #else
-        cout << "\033]0;" << title << "\007";
+        if (capabilities.windowTitle) {
+            cout << "\033]0;" << title << "\007";
+        }
     #endif
 }
 
@@ -0,0 +1,119 @@
+#include "cueSource.hpp"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const ma_data_source_vtable CueSource::vtable = {
+    CueSource::onRead,
+    CueSource::onSeek,
+    CueSource::onGetDataFormat,
+    CueSource::onGetCursor,
+    CueSource::onGetLength,
+    NULL,
+    0
+};
+
+CueSource::~CueSource() {
+    close();
+}
+
+bool CueSource::open(const string& filename) {
+    close();
+    if (ma_decoder_init_file(filename.c_str(), NULL, &decoder) != MA_SUCCESS) {
+        return false;
+    }
+
+    ma_data_source_config config = ma_data_source_config_init();
+    config.vtable = &vtable;
+    if (ma_data_source_init(&config, &base) != MA_SUCCESS) {
+        ma_decoder_uninit(&decoder);
+        return false;
+    }
+
+    #ifdef __linux__
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    #endif
+    armedFrame = NO_CUE;
+    initialized = true;
+    return true;
+}
+
+// The sound reading from this source must be uninitialized first
+void CueSource::close() {
+    if (!initialized) return;
+
+    ma_data_source_uninit(&base);
+    ma_decoder_uninit(&decoder);
+    #ifdef __linux__
+        if (wakeFd != -1) ::close(wakeFd);
+    #endif
+    wakeFd = -1;
+    initialized = false;
+}
+
+// Audio thread: read on, and post the armed cue once the cursor reaches it
+ma_result CueSource::onRead(ma_data_source* source, void* frames, ma_uint64 frameCount, ma_uint64* framesRead) {
+    CueSource* self = static_cast<CueSource*>(source);
+    ma_result result = ma_decoder_read_pcm_frames(&self->decoder, frames, frameCount, framesRead);
+
+    uint64_t cue = self->armedFrame.load(memory_order_acquire);
+    ma_uint64 cursor = 0;
+    if (cue != NO_CUE && ma_decoder_get_cursor_in_pcm_frames(&self->decoder, &cursor) == MA_SUCCESS &&
+        (cursor >= cue || result == MA_AT_END)) {
+        // disarmed until the UI thread arms the next cue
+        if (self->armedFrame.compare_exchange_strong(cue, NO_CUE, memory_order_acq_rel)) {
+            if (self->cues.push(cue)) self->postedCues++;
+            else self->droppedCues++;
+
+            #ifdef __linux__
+                uint64_t one = 1;
+                if (self->wakeFd != -1 && write(self->wakeFd, &one, sizeof(one)) < 0) {
+                    // the counter is already non-zero, the UI thread will wake anyway
+                }
+            #endif
+        }
+    }
+    return result;
+}
+
+ma_result CueSource::onSeek(ma_data_source* source, ma_uint64 frameIndex) {
+    return ma_decoder_seek_to_pcm_frame(&static_cast<CueSource*>(source)->decoder, frameIndex);
+}
+
+ma_result CueSource::onGetDataFormat(ma_data_source* source, ma_format* format, ma_uint32* channels,
+                                     ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap) {
+    return ma_data_source_get_data_format(&static_cast<CueSource*>(source)->decoder, format, channels,
+                                          sampleRate, channelMap, channelMapCap);
+}
+
+ma_result CueSource::onGetCursor(ma_data_source* source, ma_uint64* cursor) {
+    return ma_decoder_get_cursor_in_pcm_frames(&static_cast<CueSource*>(source)->decoder, cursor);
+}
+
+ma_result CueSource::onGetLength(ma_data_source* source, ma_uint64* length) {
+    return ma_decoder_get_length_in_pcm_frames(&static_cast<CueSource*>(source)->decoder, length);
+}
+
+// UI thread: the frame of the next line or word change, NO_CUE for none.
+// A frame already behind the cursor fires on the next audio period.
+void CueSource::arm(uint64_t frame) {
+    armedFrame.store(frame, memory_order_release);
+}
+
+// UI thread, after a wakeup: resets the eventfd and takes the posted cues
+size_t CueSource::acknowledge() {
+    #ifdef __linux__
+        uint64_t count;
+        if (wakeFd != -1 && read(wakeFd, &count, sizeof(count)) < 0) {
+            // nothing was pending
+        }
+    #endif
+    size_t taken = 0;
+    uint64_t frame;
+    while (cues.pop(frame)) taken++;
+    return taken;
+}
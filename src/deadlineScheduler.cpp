@@ -0,0 +1,96 @@
+#include "deadlineScheduler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+DeadlineScheduler::DeadlineScheduler() : started(Clock::now()) {
+    #ifdef __linux__
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (epollFd != -1 && timerFd != -1) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = timerFd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+        }
+    #endif
+}
+
+DeadlineScheduler::~DeadlineScheduler() {
+    #ifdef __linux__
+        if (timerFd != -1) close(timerFd);
+        if (epollFd != -1) close(epollFd);
+    #endif
+}
+
+// The caller drains the descriptor after an Event wakeup
+void DeadlineScheduler::watch(int fd) {
+    if (fd == -1) return;
+    watched.push_back(fd);
+    #ifdef __linux__
+        if (epollFd != -1) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        }
+    #endif
+}
+
+DeadlineScheduler::Wake DeadlineScheduler::waitUntil(Clock::time_point deadline) {
+    #ifdef __linux__
+        if (epollFd != -1 && timerFd != -1) {
+            // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch is the timer's
+            int64_t deadlineNs = chrono::duration_cast<chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            if (deadlineNs <= 0) deadlineNs = 1;
+            itimerspec spec = {};
+            spec.it_value.tv_sec = deadlineNs / 1000000000;
+            spec.it_value.tv_nsec = deadlineNs % 1000000000;
+            timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+            epoll_event event;
+            int ready;
+            do {
+                ready = epoll_wait(epollFd, &event, 1, -1);
+            } while (ready == -1 && errno == EINTR);
+
+            if (ready == 1 && event.data.fd != timerFd) {
+                eventWakeups++;
+                return Wake::Event;
+            }
+            uint64_t expirations;
+            if (read(timerFd, &expirations, sizeof(expirations)) < 0) {
+                // already consumed, nothing to do
+            }
+            deadlineWakeups++;
+            return Wake::Deadline;
+        }
+    #endif
+
+    // without epoll the watched descriptors cannot be waited on; check back every 5 ms
+    if (!watched.empty()) {
+        deadline = min(deadline, Clock::now() + chrono::milliseconds(5));
+    }
+    this_thread::sleep_until(deadline);
+    deadlineWakeups++;
+    return Wake::Deadline;
+}
+
+void DeadlineScheduler::resetStats() {
+    started = Clock::now();
+    deadlineWakeups = 0;
+    eventWakeups = 0;
+}
+
+double DeadlineScheduler::wakeupsPerSecond() const {
+    double seconds = chrono::duration<double>(Clock::now() - started).count();
+    return seconds > 0 ? wakeups() / seconds : 0.0;
+}
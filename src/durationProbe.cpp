@@ -0,0 +1,38 @@
+#include "durationProbe.hpp"
+#include "miniaudio.h"
+
+using namespace std;
+
+DurationProbe::~DurationProbe() {
+    stop();
+}
+
+void DurationProbe::start(const string& filename) {
+    stop();
+    state = make_shared<State>();
+    scanner = thread(scan, state, filename);
+}
+
+// A scan cannot be interrupted; it only reads frame headers, so it is short
+void DurationProbe::stop() {
+    if (scanner.joinable()) scanner.join();
+}
+
+void DurationProbe::scan(shared_ptr<State> state, string filename) {
+    ma_decoder decoder;
+    if (ma_decoder_init_file(filename.c_str(), NULL, &decoder) != MA_SUCCESS) {
+        state->lengthUs = 0;
+        return;
+    }
+
+    ma_uint64 frames = 0;
+    ma_uint32 sampleRate = 0;
+    int64_t lengthUs = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &frames) == MA_SUCCESS &&
+        ma_decoder_get_data_format(&decoder, NULL, NULL, &sampleRate, NULL, 0) == MA_SUCCESS && sampleRate > 0) {
+        lengthUs = static_cast<int64_t>(frames / sampleRate) * 1000000 +
+                   static_cast<int64_t>((frames % sampleRate) * 1000000 / sampleRate);
+    }
+    ma_decoder_uninit(&decoder);
+    state->lengthUs = lengthUs;
+}
@@ -0,0 +1,111 @@
+#include "frameBuffer.hpp"
+#include "consoleUtils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+FrameBuffer::FrameBuffer() : buffer(INITIAL_CAPACITY) {}
+
+// Only a frame larger than any before it allocates
+void FrameBuffer::grow(size_t extra) {
+    if (used + extra > buffer.size()) {
+        buffer.resize(max(buffer.size() * 2, used + extra));
+    }
+}
+
+FrameBuffer& FrameBuffer::operator<<(string_view text) {
+    grow(text.size());
+    memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+}
+
+FrameBuffer& FrameBuffer::operator<<(char c) {
+    grow(1);
+    buffer[used++] = c;
+    return *this;
+}
+
+// Non-negative values, zero padded to width digits
+void FrameBuffer::number(int64_t value, int width) {
+    char digits[24];
+    int count = 0;
+    uint64_t rest = value < 0 ? 0 : static_cast<uint64_t>(value);
+    do {
+        digits[count++] = static_cast<char>('0' + rest % 10);
+        rest /= 10;
+    } while (rest > 0);
+    while (count < width && count < static_cast<int>(sizeof(digits))) digits[count++] = '0';
+
+    grow(count);
+    while (count > 0) buffer[used++] = digits[--count];
+}
+
+// Same coordinates as ConsoleUtils::moveCursor
+void FrameBuffer::moveCursor(int x, int y) {
+    *this << "\033[";
+    number(y + 1);
+    *this << ';';
+    number(x + 1);
+    *this << 'H';
+}
+
+void FrameBuffer::setTextColor(int color) {
+    #ifdef _WIN32
+        // console attributes to SGR: the red and blue bits are swapped, bit 3 is bright
+        int code = 0;
+        if (color != RESET) {
+            code = 30 + ((color & 1) << 2) + (color & 2) + ((color & 4) >> 2) + ((color & 8) ? 60 : 0);
+        }
+    #else
+        int code = color;
+    #endif
+    *this << "\033[";
+    number(code);
+    *this << 'm';
+}
+
+void FrameBuffer::spaces(size_t count) {
+    grow(count);
+    memset(buffer.data() + used, ' ', count);
+    used += count;
+}
+
+void FrameBuffer::repeat(string_view text, size_t count) {
+    grow(text.size() * count);
+    for (size_t i = 0; i < count; i++) {
+        memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+    }
+}
+
+// One write per frame; more only if the terminal takes part of it
+void FrameBuffer::present() {
+    if (used == 0) return;
+    frames++;
+
+    size_t offset = outputFd == -1 ? used : 0;
+    while (offset < used) {
+        #ifdef _WIN32
+            int count = _write(outputFd, buffer.data() + offset, static_cast<unsigned int>(used - offset));
+        #else
+            ssize_t count = ::write(outputFd, buffer.data() + offset, used - offset);
+        #endif
+        writeCalls++;
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        offset += static_cast<size_t>(count);
+    }
+    bytesWritten += offset;
+    used = 0;
+}
@@ -0,0 +1,155 @@
+#include "libraryIndexer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include "lyricsData.hpp"
+#include "threadPool.hpp"
+
+using namespace std;
+
+static string lowerExtension(const filesystem::path& path) {
+    string extension = path.extension().string();
+    transform(extension.begin(), extension.end(), extension.begin(),
+              [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return extension;
+}
+
+LibraryIndexer::LibraryIndexer(size_t threads, bool cache) : threadCount(threads), useCache(cache) {}
+
+bool LibraryIndexer::index(const string& root, vector<LibraryTrack>& tracks, LibraryIndexStats& stats) const {
+    auto walkStart = chrono::steady_clock::now();
+
+    error_code ec;
+    filesystem::recursive_directory_iterator it(root, filesystem::directory_options::skip_permission_denied, ec);
+    if (ec) return false;
+
+    // directory + basename -> track, ordered so the report is stable
+    map<string, LibraryTrack> byBasename;
+    for (; it != filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) break;
+        if (!it->is_regular_file(ec)) continue;
+
+        const filesystem::path& path = it->path();
+        string extension = lowerExtension(path);
+        string key = (path.parent_path() / path.stem()).string();
+
+        if (extension == ".wav" || extension == ".flac" || extension == ".mp3") {
+            byBasename[key].audioPath = path.string();
+            stats.audioFiles++;
+        }
+        else if (extension == ".lrc" || extension == ".txt") {
+            LibraryTrack& track = byBasename[key];
+            // .lrc wins over a .txt with the same basename
+            if (track.lyricsPath.empty() || extension == ".lrc") {
+                track.lyricsPath = path.string();
+            }
+            stats.lyricsFiles++;
+        }
+    }
+
+    tracks.clear();
+    tracks.reserve(byBasename.size());
+    for (auto& entry : byBasename) {
+        tracks.push_back(move(entry.second));
+    }
+
+    auto parseStart = chrono::steady_clock::now();
+    stats.walkSeconds = chrono::duration<double>(parseStart - walkStart).count();
+
+    {
+        ThreadPool pool(threadCount);
+        stats.threads = pool.size();
+
+        for (LibraryTrack& track : tracks) {
+            if (track.lyricsPath.empty()) continue;
+
+            // each task writes only its own track, the vector is not resized any more
+            pool.submit([&track, this] {
+                LyricsData data;
+                bool loaded = useCache ? loadLyricsFile(track.lyricsPath, data, track.error)
+                                       : parseLyricsFile(track.lyricsPath, data, track.error);
+                if (loaded) {
+                    track.lyricsLoaded = true;
+                    track.lyricLines = data.timeline.size();
+                    // the views die with data
+                    track.title = string(data.title);
+                    track.artist = string(data.artist);
+                }
+            });
+        }
+        pool.wait();
+        stats.stolenTasks = pool.stolenTasks();
+    }
+
+    stats.parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - parseStart).count();
+
+    for (const LibraryTrack& track : tracks) {
+        if (!track.lyricsPath.empty()) stats.parsedLyrics++;
+        if (!track.audioPath.empty() && !track.lyricsPath.empty()) stats.pairedTracks++;
+        if (!track.lyricsPath.empty() && !track.lyricsLoaded) stats.failedLyrics++;
+        stats.lyricLines += track.lyricLines;
+    }
+    return true;
+}
+
+// output/main --index <directory> [--threads N] [--no-cache] [--list]
+int LibraryIndexer::run(const vector<string>& args) {
+    string root;
+    size_t threads = thread::hardware_concurrency();
+    bool cache = true;
+    bool list = false;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = static_cast<size_t>(max(1, atoi(args[++i].c_str())));
+        }
+        else if (args[i] == "--no-cache") {
+            cache = false;
+        }
+        else if (args[i] == "--list") {
+            list = true;
+        }
+        else {
+            root = args[i];
+        }
+    }
+
+    if (root.empty()) {
+        cerr << "Usage: --index <directory> [--threads N] [--no-cache] [--list]" << endl;
+        return 1;
+    }
+
+    vector<LibraryTrack> tracks;
+    LibraryIndexStats stats;
+    if (!LibraryIndexer(threads, cache).index(root, tracks, stats)) {
+        cerr << "Error: The directory could not be read: " << root << endl;
+        return 1;
+    }
+
+    for (const LibraryTrack& track : tracks) {
+        if (!track.error.empty()) {
+            cerr << "Error: " << track.error << endl;
+        }
+        if (list && !track.audioPath.empty() && track.lyricsLoaded) {
+            cout << track.audioPath << " <- " << track.lyricsPath << " (" << track.lyricLines << " lines)" << endl;
+        }
+    }
+
+    double filesPerSecond = stats.parseSeconds > 0 ? stats.parsedLyrics / stats.parseSeconds : 0.0;
+
+    cout << "Audio files:    " << stats.audioFiles << endl
+         << "Lyrics files:   " << stats.lyricsFiles << endl
+         << "Paired tracks:  " << stats.pairedTracks << endl
+         << "Failed lyrics:  " << stats.failedLyrics << endl
+         << "Lyric lines:    " << stats.lyricLines << endl
+         << "Threads:        " << stats.threads << " (" << stats.stolenTasks << " tasks stolen)" << endl
+         << fixed << setprecision(3)
+         << "Walk time:      " << stats.walkSeconds << " s" << endl
+         << "Parse time:     " << stats.parseSeconds << " s" << endl
+         << setprecision(0)
+         << "Throughput:     " << filesPerSecond << " files/s" << endl;
+    return 0;
+}
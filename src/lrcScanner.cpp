@@ -0,0 +1,111 @@
+#include "lrcScanner.hpp"
+
+using namespace std;
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool isWordChar(char c) {
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool skipDigits(string_view line, size_t& i) {
+    size_t start = i;
+    while (i < line.size() && isDigit(line[i])) i++;
+    return i != start;
+}
+
+// Consumes a time starting at pos: "digits:digits", up to two more
+// ":digits" groups and an optional ".digits" fraction.
+// LyricLine::parseTime decides what the fields mean.
+bool LrcScanner::scanTime(string_view line, size_t& pos) {
+    size_t i = pos;
+    if (!skipDigits(line, i)) return false;
+
+    int groups = 0;
+    while (groups < 3 && i < line.size() && line[i] == ':') {
+        i++;
+        if (!skipDigits(line, i)) return false;
+        groups++;
+    }
+    if (groups == 0) return false;
+
+    if (i < line.size() && line[i] == '.') {
+        i++;
+        if (!skipDigits(line, i)) return false;
+    }
+
+    pos = i;
+    return true;
+}
+
+// Pops the first "[time]" off the tags of a timestamp line and returns the time
+string_view LrcScanner::nextTime(string_view& tags) {
+    size_t close = tags.find(']');
+    if (tags.empty() || tags[0] != '[' || close == string_view::npos) {
+        tags = string_view();
+        return string_view();
+    }
+    string_view time = tags.substr(1, close - 1);
+    tags.remove_prefix(close + 1);
+    return time;
+}
+
+// Enhanced LRC word tag "<mm:ss.xx>" at pos; end is set past the '>'
+bool LrcScanner::scanWordTag(string_view text, size_t pos, string_view& time, size_t& end) {
+    if (pos >= text.size() || text[pos] != '<') return false;
+
+    size_t i = pos + 1;
+    if (!scanTime(text, i) || i >= text.size() || text[i] != '>') return false;
+
+    time = text.substr(pos + 1, i - pos - 1);
+    end = i + 1;
+    return true;
+}
+
+LrcScanResult LrcScanner::scanLine(string_view line) {
+    LrcScanResult result;
+
+    // files saved with CRLF endings
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    if (line.empty() || line[0] != '[') return result;
+
+    // [mm:ss.xx]text, or [mm:ss.xx][mm:ss.xx]...text for repeated lines
+    size_t tagsEnd = 0;
+    size_t pos = 1;
+    while (scanTime(line, pos) && pos < line.size() && line[pos] == ']') {
+        tagsEnd = pos + 1;
+        if (tagsEnd >= line.size() || line[tagsEnd] != '[') break;
+        pos = tagsEnd + 1;
+    }
+    if (tagsEnd > 0) {
+        result.kind = LrcLineKind::Timestamp;
+        result.name = line.substr(0, tagsEnd);
+        result.value = line.substr(tagsEnd);
+        return result;
+    }
+
+    // [name: value]
+    pos = 1;
+    while (pos < line.size() && isWordChar(line[pos])) pos++;
+    if (pos == 1 || pos >= line.size() || line[pos] != ':' || line.back() != ']') {
+        return result;
+    }
+
+    size_t nameEnd = pos++;
+    size_t valueEnd = line.size() - 1;
+    while (pos < valueEnd && isSpace(line[pos])) pos++;
+
+    result.kind = LrcLineKind::Tag;
+    result.name = line.substr(1, nameEnd - 1);
+    result.value = line.substr(pos, valueEnd - pos);
+    return result;
+}
@@ -2,19 +2,100 @@
 
 using namespace std;
 
-LyricLine::LyricLine(double time, const string& lyric) : timeInSeconds(time), text(lyric),
+LyricLine::LyricLine(int64_t time, string_view lyric) : timeInMicros(time), text(lyric),
 isEmpty(lyric.empty()) {}
 
-double LyricLine::parseTime(const string& timeStr) {
-    regex timeRegex(R"((\d+):(\d+)\.(\d+))");
-    smatch matches;
-    
-    if (regex_match(timeStr, matches, timeRegex)) {
-        int minutes = stoi(matches[1].str());
-        int seconds = stoi(matches[2].str());
-        int centiseconds = stoi(matches[3].str());
-        
-        return minutes * 60.0 + seconds + centiseconds / 100.0;
-    }
-    return 0.0;
-}
\ No newline at end of file
+static bool isNumber(string_view digits) {
+    if (digits.empty() || digits.size() > 9) return false;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+static int64_t toNumber(string_view digits) {
+    int64_t value = 0;
+    for (char c : digits) {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// ".5" is 500 ms, ".05" is 50 ms, ".005" is 5 ms; digits past microseconds are dropped
+static int64_t fractionToMicros(string_view digits) {
+    int64_t micros = 0;
+    int64_t scale = 100000;
+    for (size_t i = 0; i < digits.size() && scale > 0; i++) {
+        micros += (digits[i] - '0') * scale;
+        scale /= 10;
+    }
+    return micros;
+}
+
+// Accepts mm:ss, mm:ss.x up to mm:ss.xxxxxx, mm:ss:xx and hh:mm:ss[.xx].
+// Three fields without a '.' are read as mm:ss:xx, the older LRC form.
+bool LyricLine::parseTime(string_view timeStr, int64_t& timeUs) {
+    string_view fraction;
+    size_t dot = timeStr.find('.');
+    if (dot != string_view::npos) {
+        fraction = timeStr.substr(dot + 1);
+        timeStr = timeStr.substr(0, dot);
+        if (fraction.empty() || fraction.find_first_not_of("0123456789") != string_view::npos) {
+            return false;
+        }
+    }
+
+    string_view fields[3];
+    size_t count = 0;
+    while (true) {
+        if (count == 3) return false;
+        size_t colon = timeStr.find(':');
+        fields[count++] = timeStr.substr(0, colon);
+        if (colon == string_view::npos) break;
+        timeStr.remove_prefix(colon + 1);
+    }
+    if (count < 2) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (!isNumber(fields[i])) return false;
+    }
+
+    int64_t hours = 0;
+    int64_t minutes = 0;
+    int64_t seconds = 0;
+    int64_t micros = fractionToMicros(fraction);
+
+    if (count == 2) {
+        minutes = toNumber(fields[0]);
+        seconds = toNumber(fields[1]);
+    }
+    else if (fraction.empty()) {
+        minutes = toNumber(fields[0]);
+        seconds = toNumber(fields[1]);
+        micros = fractionToMicros(fields[2]);
+    }
+    else {
+        hours = toNumber(fields[0]);
+        minutes = toNumber(fields[1]);
+        seconds = toNumber(fields[2]);
+    }
+
+    timeUs = ((hours * 60 + minutes) * 60 + seconds) * 1000000 + micros;
+    return true;
+}
+
+// [offset:+/-ms] value, converted to microseconds
+bool LyricLine::parseOffset(string_view value, int64_t& offsetUs) {
+    bool negative = false;
+    if (!value.empty() && (value[0] == '+' || value[0] == '-')) {
+        negative = value[0] == '-';
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    if (!isNumber(value)) return false;
+
+    offsetUs = toNumber(value) * 1000;
+    if (negative) offsetUs = -offsetUs;
+    return true;
+}
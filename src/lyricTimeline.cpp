@@ -0,0 +1,188 @@
+#include "lyricTimeline.hpp"
+#include <algorithm>
+
+using namespace std;
+
+void LyricTimeline::reserve(size_t count) {
+    timesUs.reserve(count);
+    texts.reserve(count);
+    columns.reserve(count);
+    emptyBits.reserve((count + 63) / 64);
+    firstWord.reserve(count);
+    wordCounts.reserve(count);
+}
+
+void LyricTimeline::clear() {
+    timesUs.clear();
+    texts.clear();
+    columns.clear();
+    emptyBits.clear();
+    firstWord.clear();
+    wordCounts.clear();
+    wordOffsetsUs.clear();
+    wordPositions.clear();
+}
+
+void LyricTimeline::append(int64_t timeUs, string_view text, uint32_t textColumns,
+                           uint32_t firstWordIndex, uint32_t wordCount) {
+    size_t index = timesUs.size();
+    if (index % 64 == 0) {
+        emptyBits.push_back(0);
+    }
+    if (text.empty()) {
+        emptyBits[index / 64] |= uint64_t(1) << (index % 64);
+    }
+    timesUs.push_back(timeUs);
+    texts.push_back(text);
+    columns.push_back(textColumns);
+    firstWord.push_back(firstWordIndex);
+    wordCounts.push_back(wordCount);
+}
+
+// Returns the index of the new word, to be passed to append
+uint32_t LyricTimeline::addWord(int32_t offsetUs, uint32_t bytePosition) {
+    wordOffsetsUs.push_back(offsetUs);
+    wordPositions.push_back(bytePosition);
+    return static_cast<uint32_t>(wordOffsetsUs.size() - 1);
+}
+
+void LyricTimeline::assign(const int64_t* times, vector<string_view>&& lineTexts, const uint32_t* textColumns,
+                           const uint32_t* firstWords, const uint32_t* lineWordCounts) {
+    timesUs.assign(times, times + lineTexts.size());
+    texts = move(lineTexts);
+    columns.assign(textColumns, textColumns + texts.size());
+    firstWord.assign(firstWords, firstWords + texts.size());
+    wordCounts.assign(lineWordCounts, lineWordCounts + texts.size());
+    emptyBits.assign((texts.size() + 63) / 64, 0);
+    for (size_t i = 0; i < texts.size(); i++) {
+        if (texts[i].empty()) {
+            emptyBits[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+}
+
+void LyricTimeline::assignWords(const int32_t* offsetsUs, const uint32_t* positions, size_t count) {
+    wordOffsetsUs.assign(offsetsUs, offsetsUs + count);
+    wordPositions.assign(positions, positions + count);
+}
+
+// Stable, so lines sharing a timestamp keep their file order. Only lines
+// from index first on are reordered.
+void LyricTimeline::sortByTime(size_t first) {
+    if (first >= timesUs.size() || is_sorted(timesUs.begin() + first, timesUs.end())) return;
+
+    vector<size_t> order(timesUs.size() - first);
+    for (size_t i = 0; i < order.size(); i++) order[i] = first + i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return timesUs[a] < timesUs[b];
+    });
+
+    vector<int64_t> sortedTimes;
+    vector<string_view> sortedTexts;
+    vector<uint32_t> sortedColumns;
+    vector<uint32_t> sortedFirstWords;
+    vector<uint32_t> sortedWordCounts;
+    sortedTimes.reserve(order.size());
+    sortedTexts.reserve(order.size());
+    sortedColumns.reserve(order.size());
+    sortedFirstWords.reserve(order.size());
+    sortedWordCounts.reserve(order.size());
+    for (size_t i : order) {
+        sortedTimes.push_back(timesUs[i]);
+        sortedTexts.push_back(texts[i]);
+        sortedColumns.push_back(columns[i]);
+        sortedFirstWords.push_back(firstWord[i]);
+        sortedWordCounts.push_back(wordCounts[i]);
+    }
+
+    for (size_t k = 0; k < order.size(); k++) {
+        size_t i = first + k;
+        timesUs[i] = sortedTimes[k];
+        texts[i] = sortedTexts[k];
+        columns[i] = sortedColumns[k];
+        firstWord[i] = sortedFirstWords[k];
+        wordCounts[i] = sortedWordCounts[k];
+
+        uint64_t bit = uint64_t(1) << (i % 64);
+        emptyBits[i / 64] = texts[i].empty() ? (emptyBits[i / 64] | bit) : (emptyBits[i / 64] & ~bit);
+    }
+}
+
+// Adds lines that arrived while playing. The first keepPrefix lines have
+// already been shown and stay as they are; incoming lines timed before the
+// last of them are moved up to its time so they are shown next.
+void LyricTimeline::mergeFrom(const LyricTimeline& incoming, size_t keepPrefix) {
+    if (incoming.empty()) return;
+
+    keepPrefix = min(keepPrefix, timesUs.size());
+    int64_t earliest = keepPrefix > 0 ? timesUs[keepPrefix - 1] : numeric_limits<int64_t>::min();
+    uint32_t wordBase = static_cast<uint32_t>(wordOffsetsUs.size());
+
+    wordOffsetsUs.insert(wordOffsetsUs.end(), incoming.wordOffsetsUs.begin(), incoming.wordOffsetsUs.end());
+    wordPositions.insert(wordPositions.end(), incoming.wordPositions.begin(), incoming.wordPositions.end());
+    for (size_t i = 0; i < incoming.size(); i++) {
+        append(max(earliest, incoming.timesUs[i]), incoming.texts[i], incoming.columns[i],
+               incoming.firstWord[i] + wordBase, incoming.wordCounts[i]);
+    }
+    sortByTime(keepPrefix);
+}
+
+// Moves every line by deltaUs, clamping at the start of the song
+void LyricTimeline::shift(int64_t deltaUs) {
+    if (deltaUs == 0) return;
+    for (int64_t& timeUs : timesUs) {
+        timeUs = max<int64_t>(0, timeUs + deltaUs);
+    }
+}
+
+// Index of the line on screen at timeUs, or npos before the first line
+size_t LyricTimeline::lineAt(int64_t timeUs) const {
+    auto next = upper_bound(timesUs.begin(), timesUs.end(), timeUs);
+    if (next == timesUs.begin()) return npos;
+    return static_cast<size_t>(next - timesUs.begin()) - 1;
+}
+
+// Bytes of the line's text that have been sung at timeUs: everything before
+// the first word that has not started yet. Text ahead of the first word tag
+// counts as sung from the line's own timestamp.
+size_t LyricTimeline::highlightedBytes(size_t line, int64_t timeUs) const {
+    const int32_t* offsets = wordOffsetsUs.data() + firstWord[line];
+    const uint32_t* positions = wordPositions.data() + firstWord[line];
+    uint32_t count = wordCounts[line];
+    int64_t elapsed = timeUs - timesUs[line];
+
+    size_t started = upper_bound(offsets, offsets + count, elapsed) - offsets;
+    if (started == count) return texts[line].size();
+    return positions[started];
+}
+
+// When the highlight of the line changes next, or never once it is complete
+int64_t LyricTimeline::nextWordTime(size_t line, int64_t timeUs) const {
+    const int32_t* offsets = wordOffsetsUs.data() + firstWord[line];
+    uint32_t count = wordCounts[line];
+    int64_t elapsed = timeUs - timesUs[line];
+
+    size_t started = upper_bound(offsets, offsets + count, elapsed) - offsets;
+    if (started == count) return never;
+    return timesUs[line] + offsets[started];
+}
+
+// Steps to the next line if it is due; one line per call so every line is shown
+bool LyricTimeline::Cursor::advance(int64_t timeUs) {
+    if (nextLine < timeline->size() && timeline->timeAt(nextLine) <= timeUs) {
+        nextLine++;
+        return true;
+    }
+    return false;
+}
+
+// Jumps straight to the line at timeUs, in either direction
+size_t LyricTimeline::Cursor::seek(int64_t timeUs) {
+    size_t line = timeline->lineAt(timeUs);
+    nextLine = (line == npos) ? 0 : line + 1;
+    return line;
+}
+
+int64_t LyricTimeline::Cursor::nextTime() const {
+    return nextLine < timeline->size() ? timeline->timeAt(nextLine) : never;
+}
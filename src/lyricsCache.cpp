@@ -0,0 +1,182 @@
+#include "lyricsCache.hpp"
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#include <unordered_map>
+
+using namespace std;
+
+static const char MAGIC[4] = {'L', 'R', 'C', 'B'};
+
+static bool sourceStamp(const string& source, uint64_t& size, int64_t& mtime) {
+    error_code ec;
+    size = filesystem::file_size(source, ec);
+    if (ec) return false;
+
+    auto writeTime = filesystem::last_write_time(source, ec);
+    if (ec) return false;
+
+    mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+static bool reject(LyricsData& data) {
+    data.storage.close();
+    data.timeline.clear();
+    return false;
+}
+
+string LyricsCache::sidecarPath(const string& source) {
+    if (filesystem::path(source).extension() == ".lrc") {
+        return source + "b";
+    }
+    return source + ".lrcb";
+}
+
+bool LyricsCache::load(const string& source, LyricsData& data) {
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    if (!sourceStamp(source, sourceSize, sourceMtime)) return false;
+
+    MappedFile& file = data.storage;
+    if (!file.open(sidecarPath(source))) return false;
+    if (file.size() < sizeof(LyricsCacheHeader)) return reject(data);
+
+    LyricsCacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+
+    uint64_t lineCount = header.lineCount;
+    uint64_t wordCount = header.wordCount;
+    uint64_t expectedSize = sizeof(header) + lineCount * sizeof(int64_t) +
+                            lineCount * 5 * sizeof(uint32_t) +
+                            wordCount * (sizeof(int32_t) + sizeof(uint32_t)) + header.textSize;
+
+    // stale or foreign sidecars are ignored and rewritten after the parse
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.sourceSize != sourceSize || header.sourceMtime != sourceMtime ||
+        expectedSize != file.size()) {
+        return reject(data);
+    }
+
+    const int64_t* times = reinterpret_cast<const int64_t*>(file.data() + sizeof(header));
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(times + lineCount);
+    const uint32_t* lengths = offsets + lineCount;
+    const uint32_t* firstWords = lengths + lineCount;
+    const uint32_t* wordCounts = firstWords + lineCount;
+    const uint32_t* columns = wordCounts + lineCount;
+    const int32_t* wordOffsets = reinterpret_cast<const int32_t*>(columns + lineCount);
+    const uint32_t* wordPositions = reinterpret_cast<const uint32_t*>(wordOffsets + wordCount);
+    const char* text = reinterpret_cast<const char*>(wordPositions + wordCount);
+
+    if (uint64_t(header.titleOffset) + header.titleLength > header.textSize ||
+        uint64_t(header.artistOffset) + header.artistLength > header.textSize ||
+        uint64_t(header.lengthOffset) + header.lengthLength > header.textSize) {
+        return reject(data);
+    }
+
+    vector<string_view> texts;
+    texts.reserve(lineCount);
+    for (uint64_t i = 0; i < lineCount; i++) {
+        if (uint64_t(offsets[i]) + lengths[i] > header.textSize ||
+            uint64_t(firstWords[i]) + wordCounts[i] > wordCount) {
+            return reject(data);
+        }
+        for (uint32_t w = firstWords[i]; w < firstWords[i] + wordCounts[i]; w++) {
+            if (wordPositions[w] > lengths[i]) return reject(data);
+        }
+        texts.emplace_back(text + offsets[i], lengths[i]);
+    }
+    data.timeline.assign(times, move(texts), columns, firstWords, wordCounts);
+    data.timeline.assignWords(wordOffsets, wordPositions, wordCount);
+
+    data.title = string_view(text + header.titleOffset, header.titleLength);
+    data.artist = string_view(text + header.artistOffset, header.artistLength);
+    data.totalLength = string_view(text + header.lengthOffset, header.lengthLength);
+    data.maxLyricLength = header.maxLyricLength;
+    data.validUtf8 = (header.flags & INVALID_UTF8) == 0;
+    return true;
+}
+
+bool LyricsCache::write(const string& source, const LyricsData& data) {
+    LyricsCacheHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    if (!sourceStamp(source, header.sourceSize, header.sourceMtime)) return false;
+
+    const LyricTimeline& timeline = data.timeline;
+    vector<uint32_t> offsets;
+    vector<uint32_t> lengths;
+    string text;
+    offsets.reserve(timeline.size());
+    lengths.reserve(timeline.size());
+
+    // equal lines (shared timestamps, a repeated chorus) are written once
+    unordered_map<string_view, uint32_t> written;
+    for (size_t i = 0; i < timeline.size(); i++) {
+        string_view line = timeline.textAt(i);
+        auto found = written.find(line);
+        uint32_t offset;
+        if (found != written.end()) {
+            offset = found->second;
+        }
+        else {
+            offset = static_cast<uint32_t>(text.size());
+            written.emplace(line, offset);
+            text.append(line);
+        }
+        offsets.push_back(offset);
+        lengths.push_back(static_cast<uint32_t>(line.size()));
+    }
+
+    header.titleOffset = static_cast<uint32_t>(text.size());
+    header.titleLength = static_cast<uint32_t>(data.title.size());
+    text.append(data.title);
+    header.artistOffset = static_cast<uint32_t>(text.size());
+    header.artistLength = static_cast<uint32_t>(data.artist.size());
+    text.append(data.artist);
+    header.lengthOffset = static_cast<uint32_t>(text.size());
+    header.lengthLength = static_cast<uint32_t>(data.totalLength.size());
+    text.append(data.totalLength);
+
+    if (text.size() > numeric_limits<uint32_t>::max()) return false;
+
+    header.lineCount = static_cast<uint32_t>(timeline.size());
+    header.maxLyricLength = static_cast<uint32_t>(data.maxLyricLength);
+    header.textSize = text.size();
+    header.wordCount = static_cast<uint32_t>(timeline.totalWords());
+    header.flags = data.validUtf8 ? 0 : INVALID_UTF8;
+
+    // write beside the target and rename, so readers never map a partial file
+    string target = sidecarPath(source);
+    string temporary = target + ".tmp";
+    {
+        ofstream out(temporary, ios::binary | ios::trunc);
+        if (!out.is_open()) return false;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(timeline.times()), timeline.size() * sizeof(int64_t));
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(lengths.data()), lengths.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(timeline.firstWords()), timeline.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(timeline.lineWordCounts()), timeline.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(timeline.textColumns()), timeline.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(timeline.wordOffsets()), timeline.totalWords() * sizeof(int32_t));
+        out.write(reinterpret_cast<const char*>(timeline.wordBytePositions()), timeline.totalWords() * sizeof(uint32_t));
+        out.write(text.data(), text.size());
+        if (!out) {
+            out.close();
+            error_code ec;
+            filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    error_code ec;
+    filesystem::rename(temporary, target, ec);
+    if (ec) {
+        filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
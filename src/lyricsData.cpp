@@ -0,0 +1,165 @@
+#include "lyricsData.hpp"
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "lrcScanner.hpp"
+#include "lyricLine.hpp"
+#include "lyricsCache.hpp"
+#include "textWidth.hpp"
+
+using namespace std;
+
+static int64_t toMicros(string_view time) {
+    int64_t timeUs = 0;
+    LyricLine::parseTime(time, timeUs);
+    return timeUs;
+}
+
+// Removes enhanced LRC <mm:ss.xx> word tags from text, recording each one as
+// a word of the line. The stripped text is interned in the arena.
+string_view LrcLineParser::extractWords(string_view text, int64_t lineTimeUs,
+                                        uint32_t& firstWordIndex, uint32_t& wordCount) {
+    scratch.clear();
+    int64_t lastOffset = 0;
+    firstWordIndex = static_cast<uint32_t>(data.timeline.totalWords());
+    wordCount = 0;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        string_view time;
+        size_t tagEnd;
+        if (LrcScanner::scanWordTag(text, pos, time, tagEnd)) {
+            // word times never go backwards within a line
+            int64_t offset = max(lastOffset, toMicros(time) - lineTimeUs);
+            offset = min<int64_t>(offset, numeric_limits<int32_t>::max());
+            data.timeline.addWord(static_cast<int32_t>(offset), static_cast<uint32_t>(scratch.size()));
+            lastOffset = offset;
+            wordCount++;
+            pos = tagEnd;
+            continue;
+        }
+        scratch.push_back(text[pos++]);
+    }
+
+    if (wordCount == 0) return text;
+    return data.arena.intern(scratch);
+}
+
+LrcLineParser::LrcLineParser(LyricsData& target, bool streamed) : data(target), streaming(streamed) {}
+
+void LrcLineParser::parseLine(string_view line) {
+    LrcScanResult scanned = LrcScanner::scanLine(line);
+
+    // optional tags
+    if (scanned.kind == LrcLineKind::Tag) {
+        int64_t timeUs;
+        if (scanned.name == "length") {
+            // total duration
+            if (LyricLine::parseTime(scanned.value, timeUs)) {
+                data.totalLength = keep(scanned.value);
+            }
+        }
+        else if (scanned.name == "offset") {
+            LyricLine::parseOffset(scanned.value, offsetUs);
+        }
+        else if (scanned.name == "title" || scanned.name == "ti") {
+            data.title = keep(scanned.value);
+        }
+        else if (scanned.name == "artist" || scanned.name == "ar") {
+            data.artist = keep(scanned.value);
+        }
+        return;
+    }
+    
+    // lines of letters
+    if (scanned.kind == LrcLineKind::Timestamp) {
+        string_view tags = scanned.name;
+        string_view text = scanned.value;
+        int64_t firstTimeUs = toMicros(LrcScanner::nextTime(tags));
+
+        // word times are stored relative to the line's first timestamp
+        uint32_t firstWordIndex = 0;
+        uint32_t wordCount = 0;
+        if (text.find('<') != string_view::npos) {
+            text = extractWords(text, firstTimeUs, firstWordIndex, wordCount);
+        }
+        if (wordCount == 0) {
+            text = keep(text);
+        }
+
+        if (streaming && !TextWidth::isValidUtf8(text)) {
+            data.validUtf8 = false;
+        }
+        uint32_t columns = static_cast<uint32_t>(TextWidth::columns(text));
+
+        // every timestamp of a repeated line shares the same text slice
+        data.timeline.append(shifted(firstTimeUs), text, columns, firstWordIndex, wordCount);
+        while (!tags.empty()) {
+            data.timeline.append(shifted(toMicros(LrcScanner::nextTime(tags))), text, columns, firstWordIndex, wordCount);
+        }
+
+        if (columns > data.maxLyricLength) {
+            data.maxLyricLength = columns;
+        }
+    }
+}
+
+// Streamed lines cannot be shifted after the fact, so the offset seen so far applies now
+int64_t LrcLineParser::shifted(int64_t timeUs) const {
+    return streaming ? max<int64_t>(0, timeUs - offsetUs) : timeUs;
+}
+
+// Streamed input is gone after the line, so its text is interned in the arena
+string_view LrcLineParser::keep(string_view text) {
+    return streaming ? data.arena.intern(text) : text;
+}
+
+bool parseLyricsFile(const string& filename, LyricsData& data, string& error) {
+    if (!data.storage.open(filename)) {
+        error = "The file could not be opened: " + filename;
+        return false;
+    }
+    
+    // lyric text stays inside the mapping, so one reserve is the only allocation
+    const char* begin = data.storage.data();
+    const char* end = begin + data.storage.size();
+    size_t lineCount = 1;
+    for (const char* p = begin; (p = static_cast<const char*>(memchr(p, '\n', end - p))) != nullptr; p++) {
+        lineCount++;
+    }
+    data.timeline.clear();
+    data.timeline.reserve(lineCount);
+    data.validUtf8 = TextWidth::isValidUtf8(data.storage.view());
+
+    LrcLineParser parser(data, false);
+    const char* lineStart = begin;
+    while (lineStart < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(lineStart, '\n', end - lineStart));
+        if (lineEnd == nullptr) lineEnd = end;
+
+        parser.parseLine(string_view(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+    
+    // a positive offset makes the lyrics appear sooner
+    data.timeline.shift(-parser.offset());
+    data.timeline.sortByTime();
+
+    if (data.timeline.empty()) {
+        error = "No valid letters were found in the file: " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool loadLyricsFile(const string& filename, LyricsData& data, string& error) {
+    if (LyricsCache::load(filename, data)) {
+        return true;
+    }
+    if (!parseLyricsFile(filename, data, error)) {
+        return false;
+    }
+    LyricsCache::write(filename, data);
+    return true;
+}
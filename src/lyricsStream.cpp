@@ -0,0 +1,145 @@
+#include "lyricsStream.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+LrcStreamParser::LrcStreamParser() : lineParser(staging, true) {}
+
+void LrcStreamParser::feed(const char* bytes, size_t size) {
+    lock_guard<mutex> lock(stagingMutex);
+
+    const char* end = bytes + size;
+    while (bytes < end) {
+        const char* newline = static_cast<const char*>(memchr(bytes, '\n', end - bytes));
+        if (newline == nullptr) {
+            partialLine.append(bytes, end - bytes);
+            return;
+        }
+
+        if (partialLine.empty()) {
+            lineParser.parseLine(string_view(bytes, newline - bytes));
+        }
+        else {
+            partialLine.append(bytes, newline - bytes);
+            lineParser.parseLine(partialLine);
+            partialLine.clear();
+        }
+        bytes = newline + 1;
+    }
+}
+
+// End of input: a last line without a newline still counts
+void LrcStreamParser::finish() {
+    lock_guard<mutex> lock(stagingMutex);
+    if (!partialLine.empty()) {
+        lineParser.parseLine(partialLine);
+        partialLine.clear();
+    }
+    finished = true;
+}
+
+// Moves the lines parsed since the last call into data, see LyricTimeline::mergeFrom.
+// The text stays in the staging arena, which lives as long as this parser.
+bool LrcStreamParser::drainInto(LyricsData& data, size_t keepPrefix) {
+    lock_guard<mutex> lock(stagingMutex);
+
+    if (data.title.empty()) data.title = staging.title;
+    if (data.artist.empty()) data.artist = staging.artist;
+    if (data.totalLength.empty()) data.totalLength = staging.totalLength;
+    data.maxLyricLength = max(data.maxLyricLength, staging.maxLyricLength);
+    data.validUtf8 = data.validUtf8 && staging.validUtf8;
+
+    if (staging.timeline.empty()) return false;
+
+    data.timeline.mergeFrom(staging.timeline, keepPrefix);
+    staging.timeline.clear();
+    return true;
+}
+
+bool LrcStreamParser::isFinished() {
+    lock_guard<mutex> lock(stagingMutex);
+    return finished;
+}
+
+LyricsStream::~LyricsStream() {
+    stop();
+}
+
+bool LyricsStream::open(const string& filename, bool follow) {
+    int fd = 0;
+    if (filename != "-") {
+        #ifdef _WIN32
+            fd = _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+        #else
+            fd = ::open(filename.c_str(), O_RDONLY);
+        #endif
+        if (fd == -1) return false;
+    }
+
+    fromStdin = filename == "-";
+    state = make_shared<State>();
+    reader = thread(readLoop, state, fd, follow && filename != "-");
+    return true;
+}
+
+void LyricsStream::stop() {
+    if (!reader.joinable()) return;
+
+    state->stopping = true;
+    #ifdef _WIN32
+        // a blocking console read cannot be interrupted; the thread owns a reference to its state
+        reader.detach();
+    #else
+        reader.join();
+    #endif
+}
+
+void LyricsStream::readLoop(shared_ptr<State> state, int fd, bool follow) {
+    char buffer[4096];
+
+    while (!state->stopping) {
+        #ifndef _WIN32
+            // wake up regularly so stop() never waits on a silent pipe
+            pollfd waitFor = {fd, POLLIN, 0};
+            int ready = poll(&waitFor, 1, 100);
+            if (ready == 0 || (ready == -1 && errno == EINTR)) continue;
+        #endif
+
+        #ifdef _WIN32
+            int count = _read(fd, buffer, sizeof(buffer));
+        #else
+            ssize_t count = ::read(fd, buffer, sizeof(buffer));
+        #endif
+
+        if (count > 0) {
+            state->parser.feed(buffer, static_cast<size_t>(count));
+        }
+        else if (count == 0 && follow) {
+            // a regular file is always readable; wait for it to grow
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        else {
+            break;
+        }
+    }
+
+    state->parser.finish();
+    if (fd != 0) {
+        #ifdef _WIN32
+            _close(fd);
+        #else
+            close(fd);
+        #endif
+    }
+}
@@ -1,21 +1,155 @@
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "song.hpp"
+#include "castWriter.hpp"
+#include "allocationCounter.hpp"
+#include "benchmark.hpp"
+#include "libraryIndexer.hpp"
 
 using namespace std;
 
-int main() {
+// Runs each lyrics file through the play loop on a virtual clock, without
+// audio or terminal, and prints one line per file. The digest covers every
+// frame and its song time, so a change in timing or drawing shows up as a
+// different digest. Built with COUNT_ALLOCATIONS, a play loop that
+// allocates fails the run.
+static int replay(const vector<string>& files) {
+    if (files.empty()) {
+        cerr << "Usage: main --replay <lyrics>..." << endl;
+        return 1;
+    }
+
+    SongOptions options;
+    options.scanDuration = false;
+    options.randomSeed = 1;
+
+    int failures = 0;
+    for (const string& file : files) {
+        try {
+            VirtualClock clock;
+            Song song(file, "", options, &clock);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            ReplaySummary summary = song.replay();
+            double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            cout << file << ": " << summary.frames << " frames, " << clock.waitCount() << " waits, digest "
+                 << hex << setw(16) << setfill('0') << summary.digest << dec << setfill(' ') << ", "
+                 << fixed << setprecision(1) << summary.songUs / 1000000.0 << " s of song in "
+                 << setprecision(2) << wallMs << " ms";
+            if (AllocationCounter::enabled()) {
+                cout << ", " << summary.allocations << " allocations in the loop";
+            }
+            cout << endl;
+            if (summary.allocations > 0) failures++;
+        } catch (const exception& e) {
+            cerr << file << ": " << e.what() << endl;
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Renders the lyric display of a whole song into an asciinema recording,
+// frame times taken from the lyrics on a virtual clock
+static int cast(const vector<string>& args) {
+    if (args.size() != 2) {
+        cerr << "Usage: main --cast <lyrics> <output.cast>" << endl;
+        return 1;
+    }
+
+    SongOptions options;
+    options.scanDuration = false;
+
+    try {
+        VirtualClock clock;
+        Song song(args[0], "", options, &clock);
+
+        CastWriter recording;
+        if (!recording.open(args[1], ConsoleUtils::consoleWidth, ConsoleUtils::consoleHeight, song.displayTitle())) {
+            cerr << "Error: The file could not be written: " << args[1] << endl;
+            return 1;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        ReplaySummary summary = song.replay(&recording);
+        recording.close(summary.songUs);
+        double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        cout << args[1] << ": " << summary.frames << " frames, " << recording.eventCount() << " events, "
+             << fixed << setprecision(1)
+             << summary.songUs / 1000000.0 << " s of song in " << setprecision(2) << wallMs << " ms" << endl;
+    } catch (const exception& e) {
+        cerr << args[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+
+    if (!args.empty() && args[0] == "--bench-parse") {
+        return Benchmark::parser(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--bench-cache") {
+        return Benchmark::cache(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--bench-memory") {
+        return Benchmark::memory(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--bench-terminal") {
+        return Benchmark::terminal(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--index") {
+        return LibraryIndexer::run(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--replay") {
+        return replay(vector<string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "--cast") {
+        return cast(vector<string>(args.begin() + 1, args.end()));
+    }
+
     string filename;
     string musicFile;
-    
-    cout << "Enter the path to the lyrics file [or just filename if in current folder] (.lrc or .txt) : ";
-    getline(cin, filename);
+    SongOptions options;
 
-    cout << "Enter the path of the music file [or just filename if in current folder] (.wav, .flac, .mp3) : ";
-    getline(cin, musicFile);
+    // main [--follow] [--no-scan] [--fps N] [--headless[=fast|realtime|null]] <lyrics|-> <music>
+    // skips the prompts
+    while (!args.empty() && (args[0] == "--follow" || args[0] == "--no-scan" ||
+                             args[0].rfind("--headless", 0) == 0 ||
+                             (args[0] == "--fps" && args.size() > 1))) {
+        if (args[0] == "--follow") options.followLyrics = true;
+        else if (args[0] == "--no-scan") options.scanDuration = false;
+        else if (args[0] == "--headless" || args[0] == "--headless=fast") options.headless = HeadlessMode::Fast;
+        else if (args[0] == "--headless=realtime") options.headless = HeadlessMode::Realtime;
+        else if (args[0] == "--headless=null") options.headless = HeadlessMode::NullBackend;
+        else if (args[0].rfind("--headless", 0) == 0) {
+            cerr << "Unknown headless mode: " << args[0] << endl;
+            return 1;
+        }
+        else {
+            options.frameRate = atoi(args[1].c_str());
+            args.erase(args.begin());
+        }
+        args.erase(args.begin());
+    }
+    if (args.size() == 2) {
+        filename = args[0];
+        musicFile = args[1];
+    }
+    else {
+        cout << "Enter the path to the lyrics file [or just filename if in current folder] (.lrc or .txt) : ";
+        getline(cin, filename);
+
+        cout << "Enter the path of the music file [or just filename if in current folder] (.wav, .flac, .mp3) : ";
+        getline(cin, musicFile);
+    }
 
     try {
-        Song song(filename, musicFile);
+        Song song(filename, musicFile, options);
         song.play();
     } catch (const exception& e) {
         cerr << e.what() << endl<<endl;
@@ -25,4 +159,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,94 @@
+#include "mappedFile.hpp"
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& filename) {
+    close();
+    opened = map(filename) || readAll(filename);
+    return opened;
+}
+
+void MappedFile::close() {
+    if (mapped && mappedData != nullptr) {
+        #ifdef _WIN32
+            UnmapViewOfFile(mappedData);
+        #else
+            munmap(const_cast<char*>(mappedData), mappedSize);
+        #endif
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    buffer.clear();
+    mapped = false;
+    opened = false;
+}
+
+bool MappedFile::map(const string& filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) return false;
+
+    mappedData = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat info;
+    // empty files and pipes cannot be mapped
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    madvise(view, info.st_size, MADV_SEQUENTIAL);
+    mappedData = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(info.st_size);
+#endif
+    mapped = true;
+    return true;
+}
+
+bool MappedFile::readAll(const string& filename) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+
+    ostringstream content;
+    content << file.rdbuf();
+    buffer = content.str();
+    return true;
+}
@@ -0,0 +1,106 @@
+#include "renderer.hpp"
+
+using namespace std;
+
+Renderer::~Renderer() {
+    stop();
+}
+
+// The terminal must already be cleared; fps <= 0 sends every frame as soon as it comes
+void Renderer::start(int width, int height, int fps) {
+    inline_ = false;
+    terminal.resize(width, height);
+    snapshots.fill(vector<CellGrid::Cell>(terminal.cells()));
+    frameInterval = fps > 0 ? Clock::duration(chrono::seconds(1)) / fps : Clock::duration::zero();
+    stopping = false;
+    pending = false;
+    worker = thread(&Renderer::renderLoop, this);
+}
+
+// Renders on the caller's thread from now on, to frameSink if given and never to the terminal
+void Renderer::startInline(int width, int height, FrameSink* frameSink) {
+    inline_ = true;
+    sink = frameSink;
+    terminal.resize(width, height);
+    frame.setOutput(-1);
+}
+
+// Called by the play loop; copying into a slot of the same size does not allocate.
+// timeUs is the song time of the grid, used by inline rendering.
+void Renderer::publish(const CellGrid& grid, int64_t timeUs) {
+    if (inline_) {
+        published++;
+        terminal.setCells(grid.cells());
+        terminal.render(frame);
+        addToDigest(&timeUs, sizeof(timeUs));
+        addToDigest(frame.contents().data(), frame.contents().size());
+        if (sink) sink->frame(timeUs, frame.contents());
+        renderFrame();
+        return;
+    }
+
+    snapshots.back() = grid.cells();
+    published++;
+    if (snapshots.publish()) dropped++;
+
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        pending = true;
+    }
+    wake.notify_one();
+}
+
+// Sends the last published frame, then ends the thread
+void Renderer::stop() {
+    if (!worker.joinable()) return;
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void Renderer::renderLoop() {
+    Clock::time_point nextFrame = Clock::now();
+
+    while (true) {
+        bool finishing;
+        {
+            unique_lock<mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return pending || stopping; });
+            pending = false;
+            finishing = stopping;
+        }
+        // anything published while waiting is folded into this frame
+        if (!finishing) this_thread::sleep_until(nextFrame);
+
+        if (snapshots.take()) {
+            Clock::time_point frameStart = Clock::now();
+            terminal.setCells(snapshots.front());
+            terminal.render(frame);
+            renderFrame();
+            nextFrame = frameStart + frameInterval;
+        }
+        if (finishing) break;
+    }
+}
+
+// Writes out what render() produced and counts it as a frame
+void Renderer::renderFrame() {
+    Clock::time_point frameStart = Clock::now();
+    frame.present();
+
+    int64_t frameTimeUs = chrono::duration_cast<chrono::microseconds>(Clock::now() - frameStart).count();
+    frameTimeSumUs += frameTimeUs;
+    frameTimeMaxUs = max(frameTimeMaxUs, frameTimeUs);
+    rendered++;
+}
+
+// FNV-1a, 64 bit
+void Renderer::addToDigest(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        frameDigest = (frameDigest ^ bytes[i]) * 1099511628211ull;
+    }
+}
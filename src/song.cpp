@@ -2,104 +2,137 @@
 
 using namespace std;
 
-Song::Song(const string& lyricsFile, const string& _musicFile) :musicFile(_musicFile),audioInitialized(false) {
-    if (!loadLyricsFromFile(lyricsFile)) {
+Song::Song(const string& lyricsFile, const string& _musicFile, const SongOptions& songOptions, SongClock* injectedClock)
+    :options(songOptions),audioInitialized(false),musicFile(_musicFile),songClock(injectedClock) {
+    rng.seed(options.randomSeed ? options.randomSeed : chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    if (lyricsFile == "-" || options.followLyrics) {
+        if (!openLyricsStream(lyricsFile, options.followLyrics)) {
+            throw invalid_argument("Lyrics file invalid or not found: " + lyricsFile);
+        }
+    }
+    else if (!loadLyricsFromFile(lyricsFile)) {
         throw invalid_argument("Lyrics file invalid or not found: " + lyricsFile);
     }
     
-    if (!loadMusic(musicFile)) {
+    if (!songClock && !loadMusic(musicFile)) {
         throw runtime_error("The music file could not be loaded.: " + musicFile);
     }
 
+    // streamed lyrics are not known yet, leave room for typical lines
+    size_t lyricWidth = lyricsStream ? max<size_t>(lyrics.maxLyricLength, 60) : lyrics.maxLyricLength;
+    if (injectedClock) {
+        ConsoleUtils::consoleWidth = static_cast<int>(lyricWidth+10);
+        ConsoleUtils::consoleHeight = 20;
+        return;
+    }
     ConsoleUtils::enableUTF8Encoding();
-    ConsoleUtils::setConsoleSize(maxLyricLength+10,20);
+    ConsoleUtils::setTextColor(RESET);
+    ConsoleUtils::setConsoleSize(lyricWidth+10,20);
     ConsoleUtils::setWindowResizeable(false);
 }
 
 Song::~Song() {
     if (audioInitialized) {
         ma_sound_uninit(&music);
+        cueSource.close();
         ma_engine_uninit(&audioEngine);
     }
+    if (nullContextInitialized) {
+        ma_context_uninit(&nullContext);
+    }
 }
 
 bool Song::loadLyricsFromFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr<< endl << "Error: The file could not be opened: " << filename << endl;
+    string error;
+    if (!loadLyricsFile(filename, lyrics, error)) {
+        cerr << endl << "Error: " << error << endl;
         return false;
     }
-    
-    string line;
-    regex lrcRegex(R"(\[(\d+:\d+\.\d+)\](.*))");
-    regex lengthRegex(R"(\[length: (\d+:\d+)\])");
-    regex tagRegex(R"(\[(\w+):\s*(.*)\])");
-    smatch matches;
-    
-    while (getline(file, line)) {
-        // total duration
-        if (regex_match(line, matches, lengthRegex)) {
-            totalLength = matches[1].str();
-            continue;
-        }
-
-        // optional tags
-        if (regex_match(line, matches, tagRegex)) {
-            string tagName = matches[1].str();
-            string tagValue = matches[2].str();
-
-            if(tagName == "title" || tagName == "ti"){
-                title = tagValue;
-            }
-            else if (tagName == "artist" || tagName == "ar"){
-                artist = tagValue;
-            }
-            continue;
-        }
-        
-        // lines of letters
-        if (regex_match(line, matches, lrcRegex)) {
-            string timeStr = matches[1].str();
-            string lyricText = matches[2].str();
-            
-            double timeInSeconds = LyricLine::parseTime(timeStr);
-            lyrics.emplace_back(timeInSeconds, lyricText);
-
-            if (lyricText.size() > maxLyricLength) {
-                maxLyricLength = lyricText.size();
-            }
-        }
+    if (!lyrics.validUtf8) {
+        cerr << "Warning: " << filename << " is not valid UTF-8, some characters may not display correctly" << endl;
     }
-    
-    file.close();
-    
-    if (lyrics.empty()) {
-        cerr << "Error: No valid letters were found in the file" << endl;
+    return true;
+}
+
+bool Song::openLyricsStream(const string& filename, bool follow) {
+    lyricsStream = make_unique<LyricsStream>();
+    if (!lyricsStream->open(filename, follow)) {
+        cerr << endl << "Error: The file could not be opened: " << filename << endl;
+        lyricsStream.reset();
         return false;
     }
-    ConsoleUtils::setTextColor(RESET);
-    
+    // whatever has arrived so far; the rest is merged in while playing
+    lyricsStream->drainInto(lyrics, 0);
     return true;
 }
 
 bool Song::loadMusic(const string& musicFile){
+    // load song, decoded through the cue source
+    if (!cueSource.open(musicFile)) {
+        return false;
+    }
+
     // Initialize engine
-    ma_result result = ma_engine_init(NULL, &audioEngine);
+    ma_engine_config engineConfig = ma_engine_config_init();
+    if (options.headless == HeadlessMode::NullBackend) {
+        ma_backend backends[] = { ma_backend_null };
+        if (ma_context_init(backends, 1, NULL, &nullContext) != MA_SUCCESS) {
+            cueSource.close();
+            return false;
+        }
+        nullContextInitialized = true;
+        engineConfig.pContext = &nullContext;
+    }
+    else if (pumpsAudio()) {
+        // mixed at the song's own format, so nothing is resampled
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+        ma_data_source_get_data_format(cueSource.dataSource(), NULL, &channels, &sampleRate, NULL, 0);
+        engineConfig.noDevice = MA_TRUE;
+        engineConfig.channels = channels > 0 ? channels : 2;
+        engineConfig.sampleRate = sampleRate > 0 ? sampleRate : 48000;
+    }
+
+    ma_result result = ma_engine_init(&engineConfig, &audioEngine);
     if (result != MA_SUCCESS) {
+        cueSource.close();
         return false;
     }
-    
-    // load song
-    result = ma_sound_init_from_file(&audioEngine, musicFile.c_str(), 
-                                   MA_SOUND_FLAG_STREAM, NULL, NULL, &music);
+
+    result = ma_sound_init_from_data_source(&audioEngine, cueSource.dataSource(), 0, NULL, &music);
     
     if (result != MA_SUCCESS) {
+        cueSource.close();
         ma_engine_uninit(&audioEngine);
         return false;
     }
     
     ma_sound_set_looping(&music, MA_FALSE);
+    clock.attach(&music);
     audioInitialized = true;
+
+    if (pumpsAudio()) {
+        ownClock = make_unique<PumpedClock>(&audioEngine, clock, scheduler, cueSource,
+                                            options.headless == HeadlessMode::Realtime);
+    }
+    else {
+        ownClock = make_unique<DeviceClock>(clock, scheduler, cueSource);
+    }
+    songClock = ownClock.get();
+
+    // WAV and FLAC headers carry the exact length; for MP3 it takes a pass
+    // over every frame, which must not touch the decoder that is playing
+    string extension = filesystem::path(musicFile).extension().string();
+    transform(extension.begin(), extension.end(), extension.begin(),
+              [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    ma_uint64 frames = 0;
+    if (extension == ".mp3") {
+        if (options.scanDuration) durationProbe.start(musicFile);
+    }
+    else if (ma_sound_get_length_in_pcm_frames(&music, &frames) == MA_SUCCESS && frames > 0) {
+        durationUs = clock.framesToUs(frames);
+    }
     return true;
 }
 
@@ -107,80 +140,161 @@ void Song::playMusic(){
     if (audioInitialized) {
         ma_sound_start(&music);
     }
+    clock.start();
 }
 
-double Song::getCurrentMusicTime(){
-    if (!audioInitialized) return 0.0;
-    
-    float cursor;
-    ma_result result = ma_sound_get_cursor_in_seconds(&music, &cursor);
-    
-    if (result == MA_SUCCESS) {
-        return static_cast<double>(cursor);
-    }
-    return 0.0;
+int64_t Song::getCurrentMusicTimeUs(){
+    return songClock->nowUs();
 } 
 
-string Song::getRandomEmoji(){
-    static auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
-    static mt19937_64 rng(seed);
-    
-    uniform_int_distribution<int> dist(0, emojis.size() - 1);
+bool Song::pumpsAudio() const {
+    return options.headless == HeadlessMode::Realtime || options.headless == HeadlessMode::Fast;
+}
+
+string_view Song::getRandomEmoji(){
+    uniform_int_distribution<int> dist(0, size(emojis) - 1);
     
     return emojis[dist(rng)];
 }
 
-void Song::displayLyricWithEffect(const string& text, size_t currentIndex) {
-    if (text.empty()) return;
-    
-    // Calculate time available until the next line
-    double availableTime = 0.0;
-    if (currentIndex + 1 < lyrics.size()) {
-        availableTime = lyrics[currentIndex + 1].timeInSeconds - lyrics[currentIndex].timeInSeconds;
-    } 
-    else {
-        availableTime = 2.0;
+int64_t Song::availableTimeAfterUs(size_t index) const {
+    const LyricTimeline& timeline = lyrics.timeline;
+    if (index + 1 < timeline.size()) {
+        return timeline.timeAt(index + 1) - timeline.timeAt(index);
     }
-    
-    double typingTime = availableTime * 0.7;
-    
-    int textLength = text.length();
-    double delayPerChar = typingTime / textLength;
-    
-    int delayMs = static_cast<int>(max(0.02, min(0.2, delayPerChar)) * 1000);
-    
-    ConsoleUtils::setTextColor(LIGHT_BLUE);
-    ConsoleUtils::moveCursor(1, 7);
-    cout<<string(ConsoleUtils::consoleWidth-2,' ');
-    ConsoleUtils::moveCursor(1,7);
-
-    string emoji = getRandomEmoji();
-    cout<<emoji<<" ";
-    for (char c : text) {
-        cout << c << flush;
-        this_thread::sleep_for(chrono::milliseconds(delayMs));
-    }
-    cout << " "<<emoji;
-    ConsoleUtils::setTextColor(RESET);
+    return 2000000; // default
+}
+
+// Columns left to clear in a box row after `used` columns of content
+size_t Song::blankAfter(size_t used) {
+    size_t inner = ConsoleUtils::consoleWidth - 2;
+    return used < inner ? inner - used : 0;
+}
+
+// Types a plain line out over 70% of the time until the next line, at 20 to
+// 200 ms per column, but always finishing by the next line's timestamp.
+// Timing is anchored to the line's own timestamp, so a late start catches up
+// instead of pushing every later line back.
+void Song::startTypewriter(size_t index) {
+    const LyricTimeline& timeline = lyrics.timeline;
+    string_view text = timeline.textAt(index);
+
+    int64_t availableTimeUs = availableTimeAfterUs(index);
+    int64_t typingTimeUs = availableTimeUs * 7 / 10;
+    int64_t columns = max<int64_t>(1, timeline.columnsAt(index));
+    int64_t delayPerColumnUs = max<int64_t>(20000, min<int64_t>(200000, typingTimeUs / columns));
+
+    typewriterLine = index;
+    typewriterBytes = 0;
+    typewriterChars = 0;
+    typewriterTotalChars = 0;
+    // characters, not bytes; an invalid byte counts as a character of its own
+    for (size_t pos = 0; pos < text.size(); typewriterTotalChars++) {
+        uint32_t codePoint;
+        pos += TextWidth::nextCodePoint(text, pos, codePoint);
+    }
+    typewriterStartUs = timeline.timeAt(index);
+    typewriterEndUs = typewriterStartUs + max<int64_t>(1, min(delayPerColumnUs * columns, availableTimeUs));
+    typewriterEmoji = getRandomEmoji();
+
+    screen.setTextColor(LIGHT_BLUE);
+    screen.moveCursor(1,7);
+    screen << typewriterEmoji << " ";
+    screen.spaces(blankAfter(TextWidth::columns(typewriterEmoji) + 1));
+    screen.setTextColor(RESET);
+}
+
+// Shows every character that is due at nowUs
+void Song::stepTypewriter(int64_t nowUs) {
+    if (typewriterLine == LyricTimeline::npos) return;
+
+    int64_t spanUs = typewriterEndUs - typewriterStartUs;
+    int64_t intoLineUs = max<int64_t>(0, min(nowUs - typewriterStartUs, spanUs));
+    // a line without characters is finished as soon as it starts
+    size_t dueChars = typewriterTotalChars > 0 ? static_cast<size_t>(typewriterTotalChars * intoLineUs / spanUs) : 0;
+    if (typewriterTotalChars > 0 && dueChars <= typewriterChars) return;
+
+    string_view text = lyrics.timeline.textAt(typewriterLine);
+    size_t bytes = typewriterBytes;
+    for (size_t chars = typewriterChars; chars < dueChars; chars++) {
+        uint32_t codePoint;
+        bytes += TextWidth::nextCodePoint(text, bytes, codePoint);
+    }
+
+    // the row is redrawn from its start, other parts of the screen move the cursor in between
+    screen.setTextColor(LIGHT_BLUE);
+    screen.moveCursor(1,7);
+    screen << typewriterEmoji << " " << text.substr(0, bytes);
+    typewriterBytes = bytes;
+    typewriterChars = dueChars;
+
+    if (typewriterChars == typewriterTotalChars) {
+        size_t used = 2 * TextWidth::columns(typewriterEmoji) + 2 + lyrics.timeline.columnsAt(typewriterLine);
+        screen << " " << typewriterEmoji;
+        screen.spaces(blankAfter(used));
+        typewriterLine = LyricTimeline::npos;
+    }
+    screen.setTextColor(RESET);
+}
+
+// When the next character is due, or never when nothing is being typed
+int64_t Song::nextTypewriterTimeUs() const {
+    if (typewriterLine == LyricTimeline::npos || typewriterTotalChars == 0) return LyricTimeline::never;
+
+    int64_t spanUs = typewriterEndUs - typewriterStartUs;
+    int64_t next = static_cast<int64_t>(typewriterChars + 1);
+    int64_t total = static_cast<int64_t>(typewriterTotalChars);
+    return typewriterStartUs + (next * spanUs + total - 1) / total;
+}
+
+void Song::startKaraokeLine(size_t index) {
+    karaokeLine = index;
+    karaokeBytes = LyricTimeline::npos;
+    karaokeEmoji = getRandomEmoji();
+    karaokeColumns = 2 * TextWidth::columns(karaokeEmoji) + 2 + lyrics.timeline.columnsAt(index);
+}
+
+// Colours the sung part of the current enhanced LRC line. Called every pass
+// of the play loop with the audio position; it returns immediately unless a
+// word boundary was crossed since the last call.
+void Song::displayKaraokeLine(int64_t audioTimeUs) {
+    if (karaokeLine == LyricTimeline::npos) return;
+
+    size_t bytes = lyrics.timeline.highlightedBytes(karaokeLine, audioTimeUs);
+    if (bytes == karaokeBytes) return;
+    karaokeBytes = bytes;
+
+    string_view text = lyrics.timeline.textAt(karaokeLine);
+
+    // drawn over the previous state in place, padded to the box edge
+    screen.setTextColor(LIGHT_BLUE);
+    screen.moveCursor(1,7);
+
+    screen << karaokeEmoji << " " << text.substr(0, bytes);
+    screen.setTextColor(GRAY);
+    screen << text.substr(bytes);
+    screen.setTextColor(LIGHT_BLUE);
+    screen << " " << karaokeEmoji;
+    screen.spaces(blankAfter(karaokeColumns));
+    screen.setTextColor(RESET);
 }
 
 void Song::displayUpcomingLines(size_t currentIndex) {
     int row = 9;
 
-    ConsoleUtils::setTextColor(GRAY);
-    ConsoleUtils::moveCursor(1,row);
+    screen.setTextColor(GRAY);
+    screen.moveCursor(1,row);
     
-    for (size_t i = currentIndex + 1; i < min(currentIndex + 4, lyrics.size()); i++) {
-        if (!lyrics[i].isEmpty) {
+    for (size_t i = currentIndex + 1; i < min(currentIndex + 4, lyrics.timeline.size()); i++) {
+        if (!lyrics.timeline.isEmptyLine(i)) {
             row++;
-            ConsoleUtils::moveCursor(1,row);
-            cout<<string(ConsoleUtils::consoleWidth-2,' ');
-            ConsoleUtils::moveCursor(1,row);
-            cout<< "- " << lyrics[i].text;
+            screen.moveCursor(1,row);
+            screen << "- " << lyrics.timeline.textAt(i);
+            screen.spaces(blankAfter(2 + lyrics.timeline.columnsAt(i)));
             
         }
     }
-    ConsoleUtils::setTextColor(RESET);
+    screen.setTextColor(RESET);
 }
 
 void Song::displayPreviousLines(size_t currentIndex) {
@@ -188,22 +302,49 @@ void Song::displayPreviousLines(size_t currentIndex) {
     
     int row = (currentIndex >= 2) ? 3 : 4;
     size_t startIdx = (currentIndex >= 2) ? currentIndex - 2 : 0;
-    ConsoleUtils::setTextColor(GRAY);
+    screen.setTextColor(GRAY);
     
     for (size_t i = startIdx; i < currentIndex; i++) {
-        if (!lyrics[i].isEmpty) {
-            ConsoleUtils::moveCursor(1, row);
-            cout<<string(ConsoleUtils::consoleWidth-2,' ');
-            ConsoleUtils::moveCursor(1,row);
-            cout<<"- " << lyrics[i].text;
+        if (!lyrics.timeline.isEmptyLine(i)) {
+            screen.moveCursor(1, row);
+            screen << "- " << lyrics.timeline.textAt(i);
+            screen.spaces(blankAfter(2 + lyrics.timeline.columnsAt(i)));
             row++;
         }
     }
-    ConsoleUtils::setTextColor(RESET);
+    screen.setTextColor(RESET);
+}
+
+// Shows the animation until untilUs on the song clock, so a stalled device
+// also holds the next line back. A running animation keeps its frame.
+void Song::startAnimation(int64_t nowUs, int64_t untilUs) {
+    if (nextAnimationFrameUs == LyricTimeline::never) {
+        nextAnimationFrameUs = nowUs;
+        animationFrame = 0;
+    }
+    animationUntilUs = untilUs;
+}
+
+void Song::stopAnimation() {
+    nextAnimationFrameUs = LyricTimeline::never;
+}
+
+// Draws the next frame if it is due; nextAnimationFrameUs is the loop's next deadline
+void Song::stepAnimation(int64_t nowUs) {
+    if (nextAnimationFrameUs == LyricTimeline::never) return;
+    if (nowUs >= animationUntilUs) {
+        stopAnimation();
+        return;
+    }
+    if (nowUs < nextAnimationFrameUs) return;
+
+    displayMusicAnimation(nowUs);
+    animationFrame++;
+    nextAnimationFrameUs = max(nextAnimationFrameUs + ANIMATION_FRAME_US, nowUs);
 }
 
-void Song::displayMusicAnimation(double availableTimeInSeconds) {
-    vector<string> frames = {
+void Song::displayMusicAnimation(int64_t nowUs) {
+    static constexpr string_view frames[] = {
         "♪   ♫   ♪   ♫",
         " ♪   ♫   ♪   ♫ ",
         "  ♪   ♫   ♪   ♫  ",
@@ -211,171 +352,290 @@ void Song::displayMusicAnimation(double availableTimeInSeconds) {
         "♪   ♫   ♪   ♫"
     };
 
-    auto start = chrono::steady_clock::now();
-    int frameIndex = 0;
+    displayProgressBar(nowUs,totalTimeUs);
 
-    while (true) {
-        auto now = chrono::steady_clock::now();
-        double elapsed = chrono::duration<double>(now - start).count();
-
-        if (elapsed >= availableTimeInSeconds) break;
-        displayProgressBar(getCurrentMusicTime(),totalTimeInSeconds);
-
-        ConsoleUtils::setTextColor(LIGHT_MAGENTA);
-        ConsoleUtils::moveCursor(1, 7);
-        cout << string(ConsoleUtils::consoleWidth-5, ' ');
-        ConsoleUtils::moveCursor(1, 7);
-        cout << frames[frameIndex % frames.size()] << flush;
-        ConsoleUtils::setTextColor(RESET);
-
-        frameIndex++;
-        this_thread::sleep_for(chrono::milliseconds(250));
-    }
+    screen.setTextColor(LIGHT_MAGENTA);
+    screen.moveCursor(1, 7);
+    screen.spaces(ConsoleUtils::consoleWidth-5);
+    screen.moveCursor(1, 7);
+    screen << frames[animationFrame % size(frames)];
+    screen.setTextColor(RESET);
 }
 
-void Song::displayProgressBar(double currentTime, double totalTimeInSeconds) {
+void Song::displayProgressBar(int64_t currentUs, int64_t totalUs) {
     const int barWidth = ConsoleUtils::consoleWidth -8;
-    double progress = min(currentTime / totalTimeInSeconds, 1.0);
-    int pos = static_cast<int>(barWidth * progress);
+    int64_t clampedUs = max<int64_t>(0, min(currentUs, totalUs));
+    int pos = totalUs > 0 ? static_cast<int>(barWidth * clampedUs / totalUs) : 0;
 
-    ConsoleUtils::moveCursor(1, 16);
-    cout << string(ConsoleUtils::consoleWidth-2, ' ');
-    ConsoleUtils::moveCursor(1, 16);
+    screen.moveCursor(1, 16);
+    screen.spaces(ConsoleUtils::consoleWidth-2);
+    screen.moveCursor(1, 16);
 
-    ConsoleUtils::setTextColor(LIGHT_WHITE);
-    cout << "♫ [";
+    screen.setTextColor(LIGHT_WHITE);
+    screen << "♫ [";
 
-    ConsoleUtils::setTextColor(AQUA);
+    screen.setTextColor(AQUA);
+    screen.repeat("─", pos);
+    screen << "●";
 
-    for (int i = 0; i < pos; i++) {
-        cout << "─";
-    }
+    screen.setTextColor(GRAY);
+    screen.repeat("─", max(0, barWidth - pos - 1));
 
-    cout << "●";
-
-    ConsoleUtils::setTextColor(GRAY);
-    for (int i = pos + 1; i < barWidth; i++) {
-        cout << "─";
-    }
-
-    ConsoleUtils::setTextColor(LIGHT_WHITE);
-    cout << "] ♫";
+    screen.setTextColor(LIGHT_WHITE);
+    screen << "] ♫";
     
-    int minutes = static_cast<int>(currentTime) / 60;
-    int seconds = static_cast<int>(currentTime) % 60;
+    int64_t currentSeconds = max<int64_t>(0, currentUs) / 1000000;
     
-    ConsoleUtils::setTextColor(LIGHT_WHITE);
-    ConsoleUtils::moveCursor(1, 17);
-    cout << string(ConsoleUtils::consoleWidth-2, ' ');
-    ConsoleUtils::moveCursor(1, 17);
-
-    cout<< setfill('0') << setw(2) << minutes 
-              << ":" << setw(2) << seconds;
+    screen.setTextColor(LIGHT_WHITE);
+    screen.moveCursor(1, 17);
+    screen.spaces(ConsoleUtils::consoleWidth-2);
+    screen.moveCursor(1, 17);
+
+    screen.number(currentSeconds / 60, 2);
+    screen << ":";
+    screen.number(currentSeconds % 60, 2);
     
-    ConsoleUtils::moveCursor(ConsoleUtils::consoleWidth-6, 17);
-    cout<< totalLength;
-    ConsoleUtils::setTextColor(RESET);
+    screen.moveCursor(ConsoleUtils::consoleWidth-6, 17);
+    int64_t totalSeconds = max<int64_t>(0, totalUs) / 1000000;
+    screen.number(totalSeconds / 60, 2);
+    screen << ":";
+    screen.number(totalSeconds % 60, 2);
+    screen.setTextColor(RESET);
 }
 
-double Song::getTotalTimeInSeconds() {
-    if (totalLength.empty()) return 300.0;
-    
-    regex timeRegex(R"((\d+):(\d+))");
-    smatch matches;
-    
-    if (regex_match(totalLength, matches, timeRegex)) {
-        int minutes = stoi(matches[1].str());
-        int seconds = stoi(matches[2].str());
-        return minutes * 60.0 + seconds;
+// The decoder's length once known; until then the [length] tag is only a hint
+int64_t Song::getTotalTimeUs() {
+    if (durationUs == 0 && durationProbe.lengthUs() > 0) {
+        durationUs = durationProbe.lengthUs();
+    }
+    if (durationUs > 0) return durationUs;
+
+    int64_t lengthUs;
+    if (!lyrics.totalLength.empty() && LyricLine::parseTime(lyrics.totalLength, lengthUs)) {
+        return lengthUs;
     }
-    return 300.0;
+    // without music the song ends when its last line has had its time
+    if (!audioInitialized && !lyrics.timeline.empty()) {
+        size_t last = lyrics.timeline.size() - 1;
+        return lyrics.timeline.timeAt(last) + availableTimeAfterUs(last);
+    }
+    return 300000000;
+}
+
+// "Title - Artist" from the lyrics tags, or whichever of them is set
+string Song::displayTitle() const {
+    if (!lyrics.title.empty() && !lyrics.artist.empty()) {
+        return string(lyrics.title) + " - " + string(lyrics.artist);
+    } else if (!lyrics.title.empty()) {
+        return string(lyrics.title);
+    } else if (!lyrics.artist.empty()) {
+        return string(lyrics.artist);
+    }
+    return "Playing song";
 }
 
 void Song::play() {
-    if (lyrics.empty()) {
+    // a stream may not have delivered anything yet
+    if (lyrics.timeline.empty() && !lyricsStream) {
         cout << "Error: There are no letters to play" << endl;
         return;
     }
     
-    string consoleTitle = "Playing song";
-
-    if (!title.empty() && !artist.empty()) {
-        consoleTitle = title + " - " + artist;
-    } else if (!title.empty()) {
-        consoleTitle = title;
-    } else if (!artist.empty()) {
-        consoleTitle = artist;
-    }
-
-    ConsoleUtils::setConsoleTitle(consoleTitle);
+    ConsoleUtils::setConsoleTitle(displayTitle());
     ConsoleUtils::clearConsole();
     ConsoleUtils::setTextColor(LIGHT_GREEN);
     cout<<"ALL READY"<<endl;
-    cout<<"Press enter to start the song";
-    cin.get();
+    // stdin carries the lyrics themselves, and headless runs have nobody to press enter
+    bool interactive = (!lyricsStream || !lyricsStream->readsStdin()) && options.headless == HeadlessMode::Off;
+    if (interactive) {
+        cout<<"Press enter to start the song";
+        cin.get();
+    }
     ConsoleUtils::setTextColor(RESET);
     ConsoleUtils::setConsoleCursorVisibility(false);
     ConsoleUtils::clearConsole();
-    ConsoleUtils::drawBox(0,ConsoleUtils::consoleWidth-1,0,ConsoleUtils::consoleHeight-1,GRAY);
+    screen.resize(ConsoleUtils::consoleWidth, ConsoleUtils::consoleHeight);
+    screen.drawBox(0,ConsoleUtils::consoleWidth-1,0,ConsoleUtils::consoleHeight-1,GRAY);
+
+    // everything before the loop went through cout; frames bypass it
+    cout << flush;
+    renderer.start(ConsoleUtils::consoleWidth, ConsoleUtils::consoleHeight, options.frameRate);
+
+    DeadlineScheduler::Clock::time_point playStart = DeadlineScheduler::Clock::now();
+    runPlayback();
+    int64_t playedUs = getCurrentMusicTimeUs();
+    int64_t wallUs = chrono::duration_cast<chrono::microseconds>(DeadlineScheduler::Clock::now() - playStart).count();
+    renderer.stop();
+
+    if (lyricsStream) {
+        lyricsStream->stop();
+    }
     
-    startTime = chrono::steady_clock::now();
-    size_t currentLineIndex = 0;
-    totalTimeInSeconds = getTotalTimeInSeconds();
+    ConsoleUtils::clearConsole();
+    ConsoleUtils::setTextColor(LIGHT_MAGENTA);
+    ConsoleUtils::setConsoleCursorVisibility(true);
+    cout<<"END"<<endl;
+    ConsoleUtils::setTextColor(RESET);
+
+    // wall clock minus audio clock; a growing value means the audio fell behind
+    const ClockDriftStats& drift = clock.driftStats();
+    const FrameBuffer& output = renderer.output();
+    cout << fixed << setprecision(1)
+         << "Clock drift: " << drift.lastUs / 1000.0 << " ms last, "
+         << drift.maxAbsUs / 1000.0 << " ms max, " << drift.meanAbsUs() / 1000.0 << " ms mean ("
+         << drift.samples << " cursor updates)" << endl
+         << "Audio cues: " << cueSource.posted() << " posted, " << cueSource.dropped() << " dropped" << endl
+         << "Line lateness: " << lastLatenessUs / 1000.0 << " ms last, " << maxLatenessUs / 1000.0 << " ms max" << endl
+         << "Output: " << output.frameCount() << " frames, " << output.writeCount() << " writes, "
+         << output.byteCount() << " bytes (" << (output.frameCount() ? output.byteCount() / output.frameCount() : 0)
+         << " per frame, " << renderer.cellsRendered() << " cells changed)" << endl
+         << "Render: " << renderer.renderedCount() << " of " << renderer.publishedCount() << " frames drawn, "
+         << renderer.droppedCount() << " dropped, " << renderer.meanFrameTimeUs() / 1000.0 << " ms mean, "
+         << renderer.maxFrameTimeUs() / 1000.0 << " ms max frame time" << endl
+         << "Catch-up: " << catchUps << " jumps, " << skippedLines << " lines skipped" << endl
+         << "Played " << playedUs / 1000000.0 << " s of audio in " << wallUs / 1000000.0 << " s ("
+         << (wallUs > 0 ? static_cast<double>(playedUs) / wallUs : 0.0) << "x real time)" << endl
+         << "Wakeups: " << scheduler.wakeups() << " (" << scheduler.wakeupsPerSecond() << "/s, "
+         << scheduler.eventWakeupCount() << " from audio cues)" << endl;
+    if (interactive) {
+        cout<<"Press enter to close";
+        cin.get();
+    }
+}
+
+// Plays the lyrics against the injected clock with nothing on the terminal.
+// Every published grid is rendered on the spot, hashed with its song time
+// and handed to sink, if any.
+ReplaySummary Song::replay(FrameSink* sink) {
+    ReplaySummary summary;
+    if (lyrics.timeline.empty() && !lyricsStream) return summary;
+
+    screen.resize(ConsoleUtils::consoleWidth, ConsoleUtils::consoleHeight);
+    screen.drawBox(0,ConsoleUtils::consoleWidth-1,0,ConsoleUtils::consoleHeight-1,GRAY);
+    renderer.startInline(ConsoleUtils::consoleWidth, ConsoleUtils::consoleHeight, sink);
+
+    runPlayback();
+    if (lyricsStream) {
+        lyricsStream->stop();
+    }
+
+    summary.frames = renderer.renderedCount();
+    summary.digest = renderer.digest();
+    summary.songUs = getCurrentMusicTimeUs();
+    summary.allocations = loopAllocations;
+    return summary;
+}
+
+// The play loop, from the first line to the end of the song, drawing into
+// screen and handing each changed grid to the renderer
+void Song::runPlayback() {
+    const LyricTimeline& timeline = lyrics.timeline;
+    LyricTimeline::Cursor cursor(timeline);
+    totalTimeUs = getTotalTimeUs();
 
     playMusic();
+    songClock->start();
 
-    while (currentLineIndex < lyrics.size()) {
-        // Calculate elapsed time
-        auto currentTime = chrono::steady_clock::now();
-        elapsedTime = chrono::duration<double>(currentTime - startTime).count();
+    uint64_t allocationsBefore = AllocationCounter::count();
+    while (true) {
+        // Song position from the audio clock
+        int64_t nowUs = getCurrentMusicTimeUs();
+        // refined once a background length scan finishes
+        totalTimeUs = getTotalTimeUs();
+
+        // checked before draining so the last lines are merged before the loop ends
+        bool streaming = lyricsStream && !lyricsStream->isFinished();
+        if (lyricsStream) {
+            size_t shown = cursor.current() == LyricTimeline::npos ? 0 : cursor.current() + 1;
+            lyricsStream->drainInto(lyrics, shown);
+        }
 
-        // check if there is time before the first line
-        if (currentLineIndex == 0 && elapsedTime < lyrics[0].timeInSeconds) {
-            double timeToFirstLine = lyrics[0].timeInSeconds - elapsedTime;
+        bool linesLeft = cursor.nextTime() != LyricTimeline::never;
+        if (!linesLeft && nowUs >= totalTimeUs - 50000) {
+            break;
+        }
 
-            displayProgressBar(elapsedTime, totalTimeInSeconds);
-            displayMusicAnimation(timeToFirstLine);
-            continue;
+        // time before the first line
+        if (cursor.current() == LyricTimeline::npos && (timeline.empty() || nowUs < timeline.timeAt(0))) {
+            startAnimation(nowUs, timeline.empty() ? totalTimeUs : timeline.timeAt(0));
         }
         
-        // Check if it's time to display the current line
-        if (elapsedTime >= lyrics[currentLineIndex].timeInSeconds) {
+        // After a stall (blocked terminal, slow link) go straight to the line
+        // the audio is at; otherwise lines are shown one by one as they come due
+        size_t currentLineIndex = LyricTimeline::npos;
+        if (linesLeft && nowUs - cursor.nextTime() > CATCH_UP_US) {
+            size_t previous = cursor.current();
+            currentLineIndex = cursor.seek(nowUs);
+            skippedLines += currentLineIndex - (previous == LyricTimeline::npos ? 0 : previous + 1);
+            catchUps++;
+        }
+        else if (cursor.advance(nowUs)) {
+            currentLineIndex = cursor.current();
+        }
+
+        if (currentLineIndex != LyricTimeline::npos) {
+            karaokeLine = LyricTimeline::npos;
+            typewriterLine = LyricTimeline::npos;
+            stopAnimation();
 
-            displayProgressBar(elapsedTime,totalTimeInSeconds);
+            lastLatenessUs = nowUs - timeline.timeAt(currentLineIndex);
+            maxLatenessUs = max(maxLatenessUs, lastLatenessUs);
+
+            displayProgressBar(nowUs,totalTimeUs);
             displayPreviousLines(currentLineIndex);
             displayUpcomingLines(currentLineIndex);
             
-            if (lyrics[currentLineIndex].isEmpty) {
-                double availableTime = 0.0;
-                if (currentLineIndex + 1 < lyrics.size()) {
-                    availableTime = lyrics[currentLineIndex + 1].timeInSeconds - lyrics[currentLineIndex].timeInSeconds;
-                }
-                else {
-                    availableTime = 2.0; // default
-                }
-                displayMusicAnimation(availableTime);
+            if (timeline.isEmptyLine(currentLineIndex)) {
+                startAnimation(nowUs, timeline.timeAt(currentLineIndex) + availableTimeAfterUs(currentLineIndex));
+            }
+            else if (timeline.hasWords(currentLineIndex)) {
+                startKaraokeLine(currentLineIndex);
             }
             else {
-                displayLyricWithEffect(lyrics[currentLineIndex].text, currentLineIndex);
+                startTypewriter(currentLineIndex);
             }
-            
-            currentLineIndex++;
         }
-        
-        this_thread::sleep_for(chrono::milliseconds(5));
-    }
 
-    // After the last line, if there is time remaining
-    double remainingTime = totalTimeInSeconds - elapsedTime;
-    if (remainingTime > 0.05) {
-        displayMusicAnimation(remainingTime);
+        // After the last line has had its time, the animation fills the rest of the song
+        int64_t tailStartUs = LyricTimeline::never;
+        if (!linesLeft && cursor.current() != LyricTimeline::npos) {
+            tailStartUs = timeline.timeAt(cursor.current()) + availableTimeAfterUs(cursor.current());
+            if (nowUs >= tailStartUs) {
+                karaokeLine = LyricTimeline::npos;
+                typewriterLine = LyricTimeline::npos;
+                startAnimation(nowUs, totalTimeUs);
+            }
+        }
+
+        // word highlighting follows the audio clock, not the loop's own timing
+        displayKaraokeLine(nowUs);
+        stepTypewriter(nowUs);
+        stepAnimation(nowUs);
+        if (screen.takeChanges()) {
+            renderer.publish(screen, nowUs);
+        }
+
+        // next line or word change; the audio thread posts it when the cursor gets there
+        int64_t cueUs = cursor.nextTime();
+        if (karaokeLine != LyricTimeline::npos) {
+            cueUs = min(cueUs, timeline.nextWordTime(karaokeLine, nowUs));
+        }
+        cueSource.arm(cueUs == LyricTimeline::never ? CueSource::NO_CUE : clock.usToFrames(cueUs));
+
+        // the timer backs the cue up (the sound may have ended) and paces the animation;
+        // a clock that reads the audio itself stops exactly at the cue
+        int64_t cueSlackUs = songClock->cueSlackUs();
+        int64_t deadlineUs = min(cueUs == LyricTimeline::never ? cueUs : cueUs + cueSlackUs, nextAnimationFrameUs);
+        deadlineUs = min(deadlineUs, nextTypewriterTimeUs());
+        if (tailStartUs > nowUs) deadlineUs = min(deadlineUs, tailStartUs);
+        if (!linesLeft) deadlineUs = min(deadlineUs, totalTimeUs - 50000);
+        if (streaming) deadlineUs = min(deadlineUs, nowUs + 100000);
+
+        // nothing scheduled: look again in a while, a stream may deliver more
+        if (deadlineUs == LyricTimeline::never) deadlineUs = nowUs + 100000;
+        songClock->waitUntil(deadlineUs);
     }
-    
-    ConsoleUtils::clearConsole();
-    ConsoleUtils::setTextColor(LIGHT_MAGENTA);
-    ConsoleUtils::setConsoleCursorVisibility(true);
-    cout<<"END"<<endl;
-    cout<<"Press enter to close";
-    ConsoleUtils::setTextColor(RESET);
-    cin.get();
-}
\ No newline at end of file
+    loopAllocations = AllocationCounter::count() - allocationsBefore;
+    cueSource.arm(CueSource::NO_CUE);
+    stopAnimation();
+}
@@ -0,0 +1,65 @@
+#include "songClock.hpp"
+#include <algorithm>
+
+using namespace std;
+
+DeviceClock::DeviceClock(AudioClock& audioClock, DeadlineScheduler& deadlineScheduler, CueSource& cueSource)
+    : clock(audioClock), scheduler(deadlineScheduler), cues(cueSource) {}
+
+void DeviceClock::start() {
+    scheduler.watch(cues.wakeHandle());
+    scheduler.resetStats();
+}
+
+void DeviceClock::waitUntil(int64_t deadlineUs) {
+    int64_t sleepUs = max<int64_t>(0, deadlineUs - clock.nowUs());
+    if (scheduler.waitUntil(DeadlineScheduler::Clock::now() + chrono::microseconds(sleepUs)) ==
+        DeadlineScheduler::Wake::Event) {
+        cues.acknowledge();
+    }
+}
+
+PumpedClock::PumpedClock(ma_engine* audioEngine, AudioClock& audioClock, DeadlineScheduler& deadlineScheduler,
+                         CueSource& cueSource, bool inRealtime)
+    : engine(audioEngine), clock(audioClock), scheduler(deadlineScheduler), cues(cueSource), realtime(inRealtime),
+      buffer(CHUNK_FRAMES * ma_engine_get_channels(audioEngine)) {}
+
+void PumpedClock::start() {
+    pumpedFrames = 0;
+    started = chrono::steady_clock::now();
+    scheduler.resetStats();
+}
+
+// Mixes the song up to deadlineUs and throws the samples away. The cue
+// source sees the reads as it would from a device and posts cues the same way.
+void PumpedClock::waitUntil(int64_t deadlineUs) {
+    if (realtime) {
+        scheduler.waitUntil(started + chrono::microseconds(deadlineUs));
+    }
+
+    // rounded up, so the position afterwards is not a fraction of a frame short of the deadline
+    ma_uint64 targetFrames = clock.usToFrames(deadlineUs);
+    if (clock.framesToUs(targetFrames) < deadlineUs) targetFrames++;
+
+    while (pumpedFrames < targetFrames) {
+        ma_uint64 framesRead = 0;
+        ma_uint64 chunk = min(targetFrames - pumpedFrames, CHUNK_FRAMES);
+        if (ma_engine_read_pcm_frames(engine, buffer.data(), chunk, &framesRead) != MA_SUCCESS ||
+            framesRead == 0) {
+            break;
+        }
+        pumpedFrames += framesRead;
+    }
+    // the cue, if any, was posted by this thread's own read
+    cues.acknowledge();
+}
+
+void VirtualClock::start() {
+    timeUs = 0;
+    waits = 0;
+}
+
+void VirtualClock::waitUntil(int64_t deadlineUs) {
+    timeUs = max(timeUs, deadlineUs);
+    waits++;
+}
@@ -0,0 +1,77 @@
+#include "stringArena.hpp"
+#include <cstring>
+#include <functional>
+
+using namespace std;
+
+char* StringArena::allocate(size_t size) {
+    if (size > remaining) {
+        // oversized requests get a block of their own
+        size_t blockSize = size > nextBlockSize ? size : nextBlockSize;
+        if (nextBlockSize < BLOCK_SIZE) nextBlockSize *= 2;
+        blocks.emplace_back(new char[blockSize]);
+        cursor = blocks.back().get();
+        remaining = blockSize;
+        reservedBytes += blockSize;
+    }
+    char* result = cursor;
+    cursor += size;
+    remaining -= size;
+    usedBytes += size;
+    return result;
+}
+
+string_view StringArena::store(string_view text) {
+    if (text.empty()) return string_view();
+
+    char* copy = allocate(text.size());
+    memcpy(copy, text.data(), text.size());
+    return string_view(copy, text.size());
+}
+
+// Like store, but equal text (a repeated chorus line) is kept only once
+string_view StringArena::intern(string_view text) {
+    if (text.empty()) return string_view();
+
+    // kept at most three quarters full so probes stay short
+    if ((internedCount + 1) * 4 > internSlots.size() * 3) growInternTable();
+
+    size_t mask = internSlots.size() - 1;
+    size_t slot = hash<string_view>()(text) & mask;
+    while (internSlots[slot].data() != nullptr) {
+        if (internSlots[slot] == text) {
+            internHits++;
+            return internSlots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    internSlots[slot] = store(text);
+    internedCount++;
+    return internSlots[slot];
+}
+
+void StringArena::growInternTable() {
+    vector<string_view> old;
+    old.swap(internSlots);
+    internSlots.assign(old.empty() ? 16 : old.size() * 2, string_view());
+
+    size_t mask = internSlots.size() - 1;
+    for (string_view text : old) {
+        if (text.data() == nullptr) continue;
+        size_t slot = hash<string_view>()(text) & mask;
+        while (internSlots[slot].data() != nullptr) slot = (slot + 1) & mask;
+        internSlots[slot] = text;
+    }
+}
+
+void StringArena::clear() {
+    blocks.clear();
+    internSlots.clear();
+    internedCount = 0;
+    cursor = nullptr;
+    remaining = 0;
+    nextBlockSize = FIRST_BLOCK_SIZE;
+    usedBytes = 0;
+    reservedBytes = 0;
+    internHits = 0;
+}
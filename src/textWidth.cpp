@@ -0,0 +1,178 @@
+#include "textWidth.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXTWIDTH_SSE2 1
+#endif
+
+using namespace std;
+
+struct CodePointRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Combining marks, joiners and other code points that take no column
+static const CodePointRange ZERO_WIDTH[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E},
+    {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x2028, 0x202E},
+    {0x2060, 0x2064}, {0x20D0, 0x20FF}, {0x302A, 0x302D}, {0x3099, 0x309A},
+    {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0x1F3FB, 0x1F3FF},
+    {0xE0000, 0xE007F}, {0xE0100, 0xE01EF},
+};
+
+// East Asian wide and fullwidth characters, and emoji shown as pictures
+static const CodePointRange WIDE[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+    {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653},
+    {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB},
+    {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE}, {0x26D4, 0x26D4},
+    {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5}, {0x26FA, 0x26FA},
+    {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+    {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757},
+    {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C},
+    {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E}, {0x3041, 0x3247},
+    {0x3250, 0x4DBF}, {0x4E00, 0xA4CF}, {0xA960, 0xA97F}, {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F}, {0xFF00, 0xFF60},
+    {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4}, {0x17000, 0x18CFF}, {0x1B000, 0x1B2FF},
+    {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+    {0x1F200, 0x1F251}, {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C},
+    {0x1F37E, 0x1F393}, {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0},
+    {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F3FA}, {0x1F400, 0x1F43E}, {0x1F440, 0x1F440},
+    {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567},
+    {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F},
+    {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7},
+    {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC}, {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB},
+    {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF},
+    {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+};
+
+template <size_t N>
+static bool inRanges(const CodePointRange (&ranges)[N], uint32_t codePoint) {
+    if (codePoint < ranges[0].first || codePoint > ranges[N - 1].last) return false;
+    const CodePointRange* found = upper_bound(ranges, ranges + N, codePoint,
+        [](uint32_t value, const CodePointRange& range) { return value < range.first; });
+    return found != ranges && codePoint <= (found - 1)->last;
+}
+
+// Length of the pure ASCII run starting at pos
+static size_t asciiRun(string_view text, size_t pos) {
+    size_t start = pos;
+#ifdef TEXTWIDTH_SSE2
+    while (pos + 16 <= text.size()) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+        // one bit per byte with its high bit set; the scalar loop finds which
+        if (_mm_movemask_epi8(chunk) != 0) break;
+        pos += 16;
+    }
+#else
+    while (pos + 8 <= text.size()) {
+        uint64_t chunk;
+        memcpy(&chunk, text.data() + pos, sizeof(chunk));
+        if (chunk & 0x8080808080808080ULL) break;
+        pos += 8;
+    }
+#endif
+    while (pos < text.size() && static_cast<unsigned char>(text[pos]) < 0x80) pos++;
+    return pos - start;
+}
+
+// Columns of the ASCII bytes in [pos, end): one per printable byte, none
+// for controls such as TAB, which CellGrid does not draw either
+static size_t asciiColumns(string_view text, size_t pos, size_t end) {
+    size_t start = pos;
+    size_t controls = 0;
+#ifdef TEXTWIDTH_SSE2
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    while (pos + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+        // ASCII bytes are non-negative, so the signed compare is enough
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del))));
+        for (; mask != 0; mask &= mask - 1) controls++;
+        pos += 16;
+    }
+#endif
+    for (; pos < end; pos++) {
+        unsigned char byte = static_cast<unsigned char>(text[pos]);
+        if (byte < 0x20 || byte == 0x7F) controls++;
+    }
+    return end - start - controls;
+}
+
+// Decodes the code point at pos and returns its length in bytes. An invalid
+// or truncated sequence decodes as one byte, U+FFFD.
+size_t TextWidth::nextCodePoint(string_view text, size_t pos, uint32_t& codePoint) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    codePoint = 0xFFFD;
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    }
+
+    size_t length;
+    uint32_t minimum;
+    if (lead >= 0xC2 && lead <= 0xDF) { length = 2; minimum = 0x80; codePoint = lead & 0x1F; }
+    else if (lead >= 0xE0 && lead <= 0xEF) { length = 3; minimum = 0x800; codePoint = lead & 0x0F; }
+    else if (lead >= 0xF0 && lead <= 0xF4) { length = 4; minimum = 0x10000; codePoint = lead & 0x07; }
+    else { codePoint = 0xFFFD; return 1; }
+
+    if (pos + length > text.size()) { codePoint = 0xFFFD; return 1; }
+    for (size_t i = 1; i < length; i++) {
+        unsigned char next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) { codePoint = 0xFFFD; return 1; }
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+
+    // overlong forms, UTF-16 surrogates and values past U+10FFFF
+    if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+        codePoint = 0xFFFD;
+        return 1;
+    }
+    return length;
+}
+
+bool TextWidth::isValidUtf8(string_view text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        pos += asciiRun(text, pos);
+        if (pos >= text.size()) break;
+
+        uint32_t codePoint;
+        size_t length = nextCodePoint(text, pos, codePoint);
+        // a well formed sequence is the only way to get more than one byte
+        if (length == 1) return false;
+        pos += length;
+    }
+    return true;
+}
+
+int TextWidth::codePointColumns(uint32_t codePoint) {
+    if (codePoint < 0x20 || (codePoint >= 0x7F && codePoint < 0xA0)) return 0;
+    if (codePoint < 0x300) return 1;
+    if (inRanges(ZERO_WIDTH, codePoint)) return 0;
+    if (inRanges(WIDE, codePoint)) return 2;
+    return 1;
+}
+
+// Columns the text takes in a terminal; invalid bytes count as one column
+// each, control characters none
+size_t TextWidth::columns(string_view text) {
+    size_t total = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t run = asciiRun(text, pos);
+        total += asciiColumns(text, pos, pos + run);
+        pos += run;
+        if (pos >= text.size()) break;
+
+        uint32_t codePoint;
+        pos += nextCodePoint(text, pos, codePoint);
+        total += codePointColumns(codePoint);
+    }
+    return total;
+}
@@ -0,0 +1,96 @@
+#include "threadPool.hpp"
+
+using namespace std;
+
+// index of the worker running on this thread, or -1 outside the pool
+static thread_local long currentWorker = -1;
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.push_back(make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    // tasks spawned by a worker stay on its own deque, others are spread round robin
+    size_t index = currentWorker >= 0 ? static_cast<size_t>(currentWorker)
+                                      : nextQueue.fetch_add(1) % queues.size();
+    pendingTasks++;
+    {
+        // counted before it is visible, so a worker never takes it below zero
+        lock_guard<mutex> lock(sleepMutex);
+        queuedTasks++;
+    }
+    {
+        lock_guard<mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(sleepMutex);
+    allDone.wait(lock, [this] { return pendingTasks == 0; });
+}
+
+bool ThreadPool::popLocal(size_t index, function<void()>& task) {
+    lock_guard<mutex> lock(queues[index]->mutex);
+    if (queues[index]->tasks.empty()) return false;
+
+    task = move(queues[index]->tasks.back());
+    queues[index]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, function<void()>& task) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& victim = *queues[(thief + offset) % queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentWorker = static_cast<long>(index);
+
+    while (true) {
+        function<void()> task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queuedTasks--;
+            task();
+
+            if (--pendingTasks == 0) {
+                lock_guard<mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleepMutex);
+        workAvailable.wait(lock, [this] { return stopping || queuedTasks > 0; });
+        if (stopping && queuedTasks == 0) return;
+    }
+}
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "cellGrid.hpp"
+#include "textWidth.hpp"
+
+using namespace std;
+
+// Layout pads every row with TextWidth::columns, so it has to agree with
+// what CellGrid actually draws; run by `make check`
+
+static int failures = 0;
+
+static void expect(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+// Where the cursor ends up after drawing text from column 0
+static int drawnColumns(string_view text) {
+    CellGrid grid;
+    grid.resize(80, 1);
+    grid.moveCursor(0, 0);
+    grid << text << "|";
+    const vector<CellGrid::Cell>& cells = grid.cells();
+    for (int x = 0; x < 80; x++) {
+        if (cells[x].length == 1 && cells[x].bytes[0] == '|') return x;
+    }
+    return -1;
+}
+
+static void expectColumns(string_view text, size_t columns, const string& what) {
+    expect(TextWidth::columns(text) == columns, what + ": columns() is " + to_string(TextWidth::columns(text)) +
+                                                ", expected " + to_string(columns));
+    expect(drawnColumns(text) == static_cast<int>(columns), what + ": CellGrid draws " +
+                                                            to_string(drawnColumns(text)) + " columns");
+}
+
+int main() {
+    expectColumns("plain", 5, "ASCII");
+    expectColumns("a\tb", 2, "TAB");
+    expectColumns("\tline with a tab\tinside a run longer than sixteen bytes\t", 53, "TABs in a long run");
+    expectColumns("x\x1b[0my\x7f", 5, "ESC and DEL");
+    expectColumns("ñandú\tok", 7, "TAB after UTF-8");
+    expectColumns("bad\xff", 4, "invalid byte");
+
+    if (failures == 0) cout << "textWidthTest: all passed" << endl;
+    return failures == 0 ? 0 : 1;
+}